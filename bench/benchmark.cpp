@@ -0,0 +1,393 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+/*
+Benchmark of the solver over instance sets. Every instance goes through the
+bounds (preprocessing and lower bounds), evaluate (the height of the lower
+bound) and optimize paths, each one repeated; the instance is read again
+before every run, out of the timing. Every run is made in a child process, so
+that its peak resident memory is its own (it includes the few megabytes of the
+benchmark itself); on Windows the runs stay in the process and no memory is
+measured. Built like the solver, with src/ on the include path and every
+source of src/ but main.cpp.
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BLEU.h"
+#include "batch.h"
+#include "datareader.h"
+#include "solvercontext.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+enum benchPath { boundsPath, evaluatePath, optimizePath, numberBenchPath };
+
+const char* pathNames[numberBenchPath] = {"bounds", "evaluate", "optimize"};
+
+class BenchRun {
+ public:
+  double seconds;
+  long long nodes;
+  long peakMemoryKB;  // of the child process of the run, 0 if unknown
+};
+
+class BenchResult {
+ public:
+  std::string instance;
+  benchPath path;
+  std::vector<BenchRun> runs;
+  double median;
+  double p90;
+  double p95;
+  double nodesPerSecond;
+  long peakMemoryKB;  // the largest of the runs
+};
+
+class BenchOptions {
+ public:
+  BenchOptions()
+      : repetitions(5),
+        timeLimit(60),
+        threshold(0.10),
+        minSeconds(0.005),
+        BBNumThreads(1) {
+    for (auto& it : paths) it = true;
+  }
+  int repetitions;
+  int timeLimit;        // seconds per run
+  double threshold;     // relative slowdown flagged as a regression
+  double minSeconds;    // medians below this are too noisy to be compared
+  int BBNumThreads;
+  bool paths[numberBenchPath];
+  std::string baselineFile;
+  std::string saveFile;
+};
+
+void printUsage() {
+  std::cout
+      << "usage: benchmark [options] [instance file or directory]...\n"
+         "  --repeat N         runs per instance and path (default 5)\n"
+         "  --time-limit T     seconds per run (default 60)\n"
+         "  --paths LIST       comma separated: bounds,evaluate,optimize\n"
+         "  --bb-threads N     workers of the branch and bound (default 1)\n"
+         "  --baseline FILE    compare the medians and peak memory with FILE\n"
+         "  --threshold X      relative slowdown or memory growth flagged as a "
+         "regression (default 0.10)\n"
+         "  --min-seconds S    medians below S are not compared "
+         "(default 0.005)\n"
+         "  --save FILE        write the medians and peak memory as a new "
+         "baseline\n"
+         "Without instances, test/all instances/ and test/2sp/ are used.\n"
+         "Exits with 1 if a regression is flagged.\n";
+}
+
+// nearest rank, t_sorted non-empty
+double percentile(const std::vector<double>& t_sorted, const double t_p) {
+  size_t rank = size_t(t_p * t_sorted.size() + 0.999999);
+  rank = std::min(std::max<size_t>(rank, 1), t_sorted.size());
+  return t_sorted[rank - 1];
+}
+
+void releaseItems(std::vector<const StripPacking::item*>& t_items) {
+  for (auto& it : t_items) delete it;
+  t_items.clear();
+}
+
+/*
+One run of a path on a freshly read instance. evaluate needs the lower bound,
+which is computed first and not timed.
+*/
+BenchRun runOnce(const std::string& t_file, const benchPath t_path,
+                 const BenchOptions& t_options) {
+  BenchRun run;
+  run.seconds = 0.0;
+  run.nodes = 0;
+  run.peakMemoryKB = 0;
+  std::vector<const StripPacking::item*> items;
+  const int W = readData(t_file, items);
+  if (items.empty() || W <= 0) return run;
+  StripPacking::SolverContext context;
+  context.BBNumThreads = t_options.BBNumThreads;
+  auto start = std::chrono::steady_clock::now();
+  if (t_path == benchPath::boundsPath) {
+    StripPacking::BLEU alg(items, W, t_options.timeLimit, context);
+  } else if (t_path == benchPath::evaluatePath) {
+    int lowerBound;
+    {
+      StripPacking::SolverContext boundContext;
+      StripPacking::BLEU bounds(items, W, t_options.timeLimit, boundContext);
+      lowerBound = bounds.getLowerBound();
+    }
+    releaseItems(items);
+    readData(t_file, items);
+    start = std::chrono::steady_clock::now();
+    StripPacking::BLEU alg(items, W, lowerBound, t_options.timeLimit, context);
+    alg.evaluate();
+  } else {
+    StripPacking::BLEU alg(items, W, t_options.timeLimit, context);
+    alg.optimize();
+  }
+  run.seconds = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+  run.nodes = context.exploredNodes;
+  releaseItems(items);
+  return run;
+}
+
+/*
+runOnce in a child process, which sends the run back through a pipe; the peak
+memory is the one of the child, read by wait4. The run is made in the process
+if there is no fork, or if it fails.
+*/
+BenchRun runIsolated(const std::string& t_file, const benchPath t_path,
+                     const BenchOptions& t_options) {
+#ifndef _WIN32
+  int channel[2];
+  if (pipe(channel) == 0) {
+    std::cout.flush();
+    const pid_t child = fork();
+    if (child == 0) {
+      close(channel[0]);
+      const BenchRun run = runOnce(t_file, t_path, t_options);
+      const bool sent = write(channel[1], &run, sizeof(run)) == sizeof(run);
+      _exit(sent ? 0 : 1);
+    }
+    close(channel[1]);
+    if (child > 0) {
+      BenchRun run;
+      const bool received =
+          read(channel[0], &run, sizeof(run)) == ssize_t(sizeof(run));
+      close(channel[0]);
+      int status = 0;
+      struct rusage usage;
+      if (wait4(child, &status, 0, &usage) == child && received &&
+          WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+#ifdef __APPLE__
+        run.peakMemoryKB = usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+        run.peakMemoryKB = usage.ru_maxrss;  // kilobytes on Linux
+#endif
+        return run;
+      }
+      std::cerr << "the run of " << t_file << " failed" << std::endl;
+      BenchRun failed;
+      failed.seconds = 0.0;
+      failed.nodes = 0;
+      failed.peakMemoryKB = 0;
+      return failed;
+    }
+    close(channel[0]);
+  }
+#endif
+  return runOnce(t_file, t_path, t_options);
+}
+
+BenchResult runPath(const std::string& t_file, const benchPath t_path,
+                    const BenchOptions& t_options) {
+  BenchResult result;
+  result.instance = t_file;  // 2sp/ and all instances/ share names
+  result.path = t_path;
+  for (int i = 0; i < t_options.repetitions; ++i)
+    result.runs.push_back(runIsolated(t_file, t_path, t_options));
+  std::vector<double> seconds;
+  double totalSeconds = 0.0;
+  long long totalNodes = 0;
+  result.peakMemoryKB = 0;
+  for (const auto& it : result.runs) {
+    seconds.push_back(it.seconds);
+    totalSeconds += it.seconds;
+    totalNodes += it.nodes;
+    result.peakMemoryKB = std::max(result.peakMemoryKB, it.peakMemoryKB);
+  }
+  std::sort(seconds.begin(), seconds.end());
+  result.median = seconds.size() % 2 == 1
+                      ? seconds[seconds.size() / 2]
+                      : (seconds[seconds.size() / 2 - 1] +
+                         seconds[seconds.size() / 2]) /
+                            2;
+  result.p90 = percentile(seconds, 0.90);
+  result.p95 = percentile(seconds, 0.95);
+  result.nodesPerSecond = totalSeconds > 0 ? totalNodes / totalSeconds : 0.0;
+  return result;
+}
+
+class BaselineEntry {
+ public:
+  double median;
+  long long nodes;
+  long peakMemoryKB;  // 0 if unknown
+};
+
+/*
+Baseline lines: "<instance> <path> <median seconds> <nodes of the first run>
+<peak memory in KB>". The files saved before the memory was measured have no
+peakKB in their header and no last field.
+*/
+std::map<std::string, BaselineEntry> readBaseline(const std::string& t_file) {
+  std::map<std::string, BaselineEntry> baseline;
+  std::ifstream ifs(t_file);
+  std::string line;
+  size_t numberValues = 2;  // after the instance and the path
+  while (std::getline(ifs, line)) {
+    if (line.empty()) continue;
+    if (line[0] == '#') {
+      if (line.find("peakKB") != std::string::npos) numberValues = 3;
+      continue;
+    }
+    // instance names may contain spaces, the last fields do not
+    std::istringstream ss(line);
+    std::vector<std::string> fields;
+    std::string field;
+    while (ss >> field) fields.push_back(field);
+    if (fields.size() < numberValues + 2) continue;
+    const size_t path = fields.size() - numberValues - 1;
+    std::string instance = fields[0];
+    for (size_t i = 1; i < path; ++i) instance += " " + fields[i];
+    BaselineEntry entry;
+    entry.median = std::stod(fields[path + 1]);
+    entry.nodes = std::stoll(fields[path + 2]);
+    entry.peakMemoryKB = numberValues > 2 ? std::stol(fields[path + 3]) : 0;
+    baseline[instance + " " + fields[path]] = entry;
+  }
+  return baseline;
+}
+
+const bool parsePaths(const std::string& t_list, bool* t_paths) {
+  for (int i = 0; i < numberBenchPath; ++i) t_paths[i] = false;
+  std::istringstream ss(t_list);
+  std::string name;
+  while (std::getline(ss, name, ',')) {
+    const auto it = std::find_if(
+        std::begin(pathNames), std::end(pathNames),
+        [&name](const char* t_name) { return name == t_name; });
+    if (it == std::end(pathNames)) return false;
+    t_paths[it - std::begin(pathNames)] = true;
+  }
+  return true;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  BenchOptions options;
+  std::vector<std::string> inputs;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--repeat" && hasValue)
+      options.repetitions = std::max(1, std::stoi(argv[++i]));
+    else if (arg == "--time-limit" && hasValue)
+      options.timeLimit = std::stoi(argv[++i]);
+    else if (arg == "--paths" && hasValue && parsePaths(argv[i + 1],
+                                                        options.paths))
+      ++i;
+    else if (arg == "--bb-threads" && hasValue)
+      options.BBNumThreads = std::stoi(argv[++i]);
+    else if (arg == "--baseline" && hasValue)
+      options.baselineFile = argv[++i];
+    else if (arg == "--threshold" && hasValue)
+      options.threshold = std::stod(argv[++i]);
+    else if (arg == "--min-seconds" && hasValue)
+      options.minSeconds = std::stod(argv[++i]);
+    else if (arg == "--save" && hasValue)
+      options.saveFile = argv[++i];
+    else if (arg == "--help" || arg[0] == '-') {
+      printUsage();
+      return arg == "--help" ? 0 : 2;
+    } else
+      inputs.push_back(arg);
+  }
+  if (inputs.empty()) {
+    inputs.push_back("test/all instances/");
+    inputs.push_back("test/2sp/");
+  }
+  std::vector<std::string> files;
+  for (const auto& it : inputs)
+    for (const auto& job : StripPacking::listJobs(
+             it, StripPacking::batchMode::evaluateHeight, 0, 0))
+      files.push_back(job.file);
+  std::map<std::string, BaselineEntry> baseline;
+  if (!options.baselineFile.empty())
+    baseline = readBaseline(options.baselineFile);
+
+  std::vector<BenchResult> results;
+  int regressions = 0;
+  char line[256];
+  std::snprintf(line, sizeof(line), "%-36s %-9s %10s %10s %10s %12s %10s",
+                "instance", "path", "median(s)", "p90(s)", "p95(s)",
+                "nodes/s", "peakKB");
+  std::cout << line << (baseline.empty() ? "" : "   vs baseline") << "\n";
+  for (const auto& file : files) {
+    for (int p = 0; p < numberBenchPath; ++p) {
+      if (!options.paths[p]) continue;
+      results.push_back(runPath(file, benchPath(p), options));
+      const auto& result = results.back();
+      std::snprintf(line, sizeof(line),
+                    "%-36s %-9s %10.4f %10.4f %10.4f %12.0f %10ld",
+                    result.instance.c_str(), pathNames[p], result.median,
+                    result.p90, result.p95, result.nodesPerSecond,
+                    result.peakMemoryKB);
+      std::cout << line;
+      const auto base =
+          baseline.find(result.instance + " " + pathNames[p]);
+      if (base != baseline.end()) {
+        const double reference = base->second.median;
+        std::snprintf(line, sizeof(line), "   %+6.1f%%",
+                      reference > 0 ? 100.0 * (result.median / reference - 1)
+                                    : 0.0);
+        std::cout << line;
+        if (std::max(result.median, reference) >= options.minSeconds &&
+            result.median > reference * (1 + options.threshold)) {
+          std::cout << " REGRESSION";
+          ++regressions;
+        }
+        // both peaks are known
+        const long referenceKB = base->second.peakMemoryKB;
+        if (referenceKB > 0 && result.peakMemoryKB > 0) {
+          const double growth =
+              double(result.peakMemoryKB) / referenceKB - 1;
+          std::snprintf(line, sizeof(line), "   mem %+6.1f%%", 100.0 * growth);
+          std::cout << line;
+          if (result.peakMemoryKB > referenceKB * (1 + options.threshold)) {
+            std::cout << " MEMORY REGRESSION";
+            ++regressions;
+          }
+        }
+        // the sequential search is deterministic, a different count is
+        // another tree
+        if (options.BBNumThreads == 1 &&
+            base->second.nodes != result.runs.front().nodes)
+          std::cout << " (nodes " << base->second.nodes << " -> "
+                    << result.runs.front().nodes << ")";
+      }
+      std::cout << std::endl;
+    }
+  }
+  if (!options.saveFile.empty()) {
+    std::ofstream ofs(options.saveFile);
+    ofs << "# instance path medianSeconds nodes peakKB\n";
+    for (const auto& it : results)
+      ofs << it.instance << " " << pathNames[it.path] << " " << it.median
+          << " " << it.runs.front().nodes << " " << it.peakMemoryKB << "\n";
+  }
+  if (!baseline.empty())
+    std::cout << regressions << " regression(s) over a threshold of "
+              << options.threshold * 100 << "%" << std::endl;
+  return regressions > 0 ? 1 : 0;
+}
@@ -7,31 +7,37 @@
 #include "BLEU.h"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <stack>
+#include <thread>
 
+#include "heuristic.h"
 #include "knapsack.h"
 #include "spp.h"
 double StripPacking::BLEU::tolerance = 0.0001;
 int StripPacking::BLEU::bigNumber = 999999;
-int StripPacking::BLEU::BBMaxExplNodesPerPack = 10000000;
-int StripPacking::BLEU::BBMaxExplNodesNonPerPack = 80000;
-int StripPacking::BLEU::interestingStatics = 0;
-int StripPacking::BLEU::ycheckExplNode = 10000000;
-bool StripPacking::BLEU::nodeLimitFlag = false;
-StripPacking::algorithmStatus StripPacking::BLEU::algStatus =
-    StripPacking::algorithmStatus::exact;
 /*
 only invoke when it's in evaluatedMode
 */
 StripPacking::BLEU::BLEU(const std::vector<const item*>& t_items, const int t_W,
-                         const int t_TrialHeight, const int t_timeLimit)
+                         const int t_TrialHeight, const int t_timeLimit,
+                         SolverContext& t_context)
     : _allItems(t_items),
       _W(t_W),
+      _bestLowerBound(0),
+      _bestUpperBound(-1),
+      _decidingBound(lowerBoundKind::boundLB1),
       _trialHeight(t_TrialHeight),
       _evaluatedMode(true),
-      _timeLimit(t_timeLimit) {
+      _timeLimit(t_timeLimit),
+      _context(t_context) {
+  // the preprocessing and the bounds count in the time limit
+  _context.setTimeLimit(_timeLimit);
   // sort the items by the nonincreasing of width and breaking ties by
   // nonincreasing height
   std::sort(_allItems.begin(), _allItems.end(), compareItemByWidth);
@@ -41,11 +47,17 @@ StripPacking::BLEU::BLEU(const std::vector<const item*>& t_items, const int t_W,
 }
 
 StripPacking::BLEU::BLEU(const std::vector<const item*>& t_items, const int t_W,
-                         const int t_timeLimit)
+                         const int t_timeLimit, SolverContext& t_context)
     : _allItems(t_items),
       _W(t_W),
+      _bestLowerBound(0),
+      _bestUpperBound(-1),
+      _decidingBound(lowerBoundKind::boundLB1),
+      _trialHeight(-1),
       _evaluatedMode(false),
-      _timeLimit(t_timeLimit) {
+      _timeLimit(t_timeLimit),
+      _context(t_context) {
+  _context.setTimeLimit(_timeLimit);
   // sort the items by the nonincreasing of width and breaking ties by
   // nonincreasing height
   std::sort(_allItems.begin(), _allItems.end(), compareItemByWidth);
@@ -67,6 +79,7 @@ void StripPacking::BLEU::reassignItemsIdx() {
 const StripPacking::solutionStatus StripPacking::BLEU::evaluate() {
   if (_processedItems.empty()) return solutionStatus::feasible;
   if (_bestLowerBound > _trialHeight) return solutionStatus::infeasible;
+  if (_context.timeUp()) return solutionStatus::pending;
   int binWidth = _processedW;
   int binHeight = _trialHeight - _processedH;
   int increment = 0;
@@ -81,15 +94,46 @@ const StripPacking::solutionStatus StripPacking::BLEU::evaluate() {
   std::vector<const item*> Items;
   for (const auto& it : tmpItems) Items.push_back(std::move(it));
   // end preprocess
-  auto status = this->branchAndBound(Items, binWidth, binHeight);
-  BLEU::algStatus =
-      (BLEU::nodeLimitFlag && status == solutionStatus::infeasible)
+  auto status =
+      this->branchAndBound(Items, binWidth, binHeight, _context.BBStrategy);
+  _context.algStatus =
+      (_context.nodeLimitFlag && status == solutionStatus::infeasible)
           ? algorithmStatus::approximate
-          : BLEU::algStatus;
+          : _context.algStatus;
   this->releaseTmpItems(Items);
   return status;
 }
 
+const int StripPacking::BLEU::optimize() {
+  // the best-fit height of the bounds may already be optimal
+  if (_bestUpperBound < 0 || _bestUpperBound > _bestLowerBound)
+    _bestUpperBound = this->heuristicUpperBound();
+  int lowest = _bestLowerBound;  // the smallest height not ruled out yet
+  bool firstProbe = true;
+  while (lowest < _bestUpperBound && !_context.timeUp()) {
+    // most instances are solved at the lower bound, try it before bisecting
+    _trialHeight = firstProbe ? lowest
+                              : lowest + (_bestUpperBound - lowest) / 2;
+    firstProbe = false;
+    _context.algStatus = algorithmStatus::exact;
+    auto status = this->evaluate();
+    if (status == solutionStatus::feasible) {
+      _bestUpperBound = _trialHeight;
+      continue;
+    }
+    // a proven infeasible height rules out all the smaller ones as well
+    if (status == solutionStatus::infeasible &&
+        _context.algStatus == algorithmStatus::exact)
+      _bestLowerBound = std::max(_bestLowerBound, _trialHeight + 1);
+    lowest = _trialHeight + 1;
+  }
+  _trialHeight = _bestUpperBound;
+  _context.algStatus = _bestLowerBound == _bestUpperBound
+                           ? algorithmStatus::exact
+                           : algorithmStatus::approximate;
+  return _bestUpperBound;
+}
+
 const StripPacking::solutionStatus StripPacking::BLEU::solvePCC()
 // solve the parallel machine scheduling with contiguity constraints
 {
@@ -130,17 +174,39 @@ Return: if it is a feasible solution for the SPP then return true, else false
 bool StripPacking::BLEU::yCheckAlgorithm(
     const int t_processedW, const int t_TrialHeight,
     const std::vector<coordinate>& itemPositions,
-    const std::vector<const item*> t_processedItems) const
+    const std::vector<const item*>& t_processedItems) const
 
 {
+  PhaseTimer timer(_context.statistics, yCheckPhase);
+  _context.statistics.yCheckCalls++;
+  // many leaves place the same sizes on the same columns
+  std::vector<int> key;
+  YCheckCache::makeKey(t_processedW, t_TrialHeight, t_processedItems,
+                       itemPositions, key);
+  int cached = _context.yCheckCache.find(key);
+  if (cached == 1) _context.statistics.yCheckFeasible++;
+  if (cached >= 0) return cached == 1;
   std::vector<coordinate> Cords4yCheck = itemPositions;
   int binWidth = t_processedW;
   auto Items = this->preprocess4yCheck(binWidth, t_processedItems, Cords4yCheck,
                                        t_TrialHeight);
-  bool result =
-      (this->yCheckEnumerationTree(Items, Cords4yCheck, t_TrialHeight,
-                                   binWidth) == solutionStatus::feasible);
+  // and more of them are the same instance after the preprocessing
+  std::vector<int> reducedKey;
+  YCheckCache::makeKey(binWidth, t_TrialHeight, Items, Cords4yCheck,
+                       reducedKey);
+  cached = _context.yCheckCache.find(reducedKey);
+  bool result = cached == 1;
+  bool exact = true;
+  if (cached < 0) {
+    auto status = this->yCheckEnumerationTree(Items, Cords4yCheck,
+                                              t_TrialHeight, binWidth);
+    result = status == solutionStatus::feasible;
+    exact = status != solutionStatus::pending;
+    if (exact) _context.yCheckCache.insert(reducedKey, result);
+  }
   this->releaseTmpItems(Items);
+  if (exact) _context.yCheckCache.insert(key, result);
+  if (result) _context.statistics.yCheckFeasible++;
   // bool result = (this->yCheckEnumerationTree(t_processedItems, itemPositions,
   // t_TrialHeight 	, t_processedW) == solutionStatus::feasible);
   return result;
@@ -161,12 +227,13 @@ StripPacking::solutionStatus StripPacking::BLEU::yCheckEnumerationTree(
     return solutionStatus::infeasible;  // it could happen when the very item
                                         // ends at the current last column, then
                                         // there will be no space for any merge
-  std::unique_ptr<BBNode> root(
-      new BBNode(t_InterestItems, t_Cords, t_Width, t_Height));
-  std::stack<std::unique_ptr<BBNode>> yEnTree;
-  yEnTree.push(std::move(root));
+  BBNodePool pool;
+  std::stack<BBNodePtr> yEnTree;
+  yEnTree.push(pool.makeNode(t_InterestItems, t_Cords, t_Width, t_Height));
   int exploreNodes = 0;
   while (!yEnTree.empty()) {
+    SolverStatistics::updateMax(_context.statistics.yCheckMaxStackSize,
+                                yEnTree.size());
     const auto currentNode = std::move(yEnTree.top());
     yEnTree.pop();
     if (currentNode->remainingItems.empty()) {
@@ -174,9 +241,14 @@ StripPacking::solutionStatus StripPacking::BLEU::yCheckEnumerationTree(
     }
     if (this->yCheckBounding(currentNode)) continue;
     exploreNodes++;
-    this->yCheckMakeBranch(currentNode, yEnTree);
-    if (exploreNodes > StripPacking::BLEU::ycheckExplNode) {
-      StripPacking::BLEU::nodeLimitFlag = true;
+    _context.statistics.yCheckNodes++;
+    if (this->checkpoint(exploreNodes,
+                         int(t_InterestItems.size() -
+                             currentNode->remainingItems.size())))
+      return solutionStatus::pending;
+    this->yCheckMakeBranch(currentNode, yEnTree, pool);
+    if (exploreNodes > _context.ycheckExplNode) {
+      _context.nodeLimitFlag = true;
       return solutionStatus::pending;
     }
   }
@@ -184,17 +256,16 @@ StripPacking::solutionStatus StripPacking::BLEU::yCheckEnumerationTree(
 }
 
 bool StripPacking::BLEU::yCheckBounding(
-    const std::unique_ptr<BBNode>& t_currentNode) const {
+    const BBNodePtr& t_currentNode) const {
   // fathoming criteria 1
-  for (size_t i = 0; i < t_currentNode->columnsOccupiedHeight.size(); ++i) {
-    int sumHeight = t_currentNode->columnsOccupiedHeight[i];
-    for (auto it : t_currentNode->remainingItems) {
-      if (t_currentNode->itemPositions[it->idxHelper].x <= i &&
-          t_currentNode->itemPositions[it->idxHelper].x + it->width - 1 >= i) {
-        sumHeight += it->height;
-      }
-      if (sumHeight > t_currentNode->trialHeight) return true;
-    }
+  const auto& occupied = t_currentNode->columnsOccupiedHeight;
+  const auto& demand = t_currentNode->columnsDemand;
+  int highest = 0;
+  for (size_t i = 0; i < occupied.size(); ++i)
+    highest = std::max(highest, occupied[i] + demand[i]);
+  if (highest > t_currentNode->trialHeight) {
+    _context.statistics.fathom(yCheckColumnHeight);
+    return true;
   }
 
   if (!t_currentNode->packedItems.empty()) {
@@ -204,8 +275,10 @@ bool StripPacking::BLEU::yCheckBounding(
       if (tmpItem->height == it->height && tmpItem->width == it->width &&
           t_currentNode->itemPositions[tmpItem->idxHelper].x ==
               t_currentNode->itemPositions[it->idxHelper].x &&
-          it->idx < tmpItem->idx)
+          it->idx < tmpItem->idx) {
+        _context.statistics.fathom(yCheckIdenticalItems);
         return true;
+      }
     }
   }
 
@@ -221,6 +294,7 @@ bool StripPacking::BLEU::yCheckBounding(
         if (t_currentNode->itemPositions[itemK->idxHelper].y ==
             t_currentNode->columnsOccupiedHeight[p_js] - itemJ->height -
                 itemK->height) {
+          _context.statistics.fathom(yCheckSwappedItems);
           return true;
         }
       }
@@ -229,10 +303,10 @@ bool StripPacking::BLEU::yCheckBounding(
   return false;
 }
 
-void StripPacking::BLEU::yCheckMakeBranch(
-    const std::unique_ptr<BBNode>& t_currentNode,
-    std::stack<std::unique_ptr<BBNode>>& t_yEntree) const {
-  std::list<std::unique_ptr<BBNode>> children;
+void StripPacking::BLEU::yCheckMakeBranch(const BBNodePtr& t_currentNode,
+                                          std::stack<BBNodePtr>& t_yEntree,
+                                          BBNodePool& t_pool) const {
+  std::list<BBNodePtr> children;
   std::vector<const item*> copyRemainingItems = t_currentNode->remainingItems;
   std::sort(copyRemainingItems.begin(), copyRemainingItems.end(),
             compareItemByxCords(t_currentNode->itemPositions));
@@ -280,8 +354,7 @@ void StripPacking::BLEU::yCheckMakeBranch(
         }
       }
       if (fathom) continue;
-      std::unique_ptr<BBNode> child(
-          new BBNode(*t_currentNode, copyRemainingItems[i]));
+      auto child = t_pool.makeNode(*t_currentNode, copyRemainingItems[i]);
       child->itemPositions[copyRemainingItems[i]->idxHelper].y =
           child->columnsOccupiedHeight
               [child->itemPositions[copyRemainingItems[i]->idxHelper].x];
@@ -290,6 +363,7 @@ void StripPacking::BLEU::yCheckMakeBranch(
                    copyRemainingItems[i]->width;
            ++j) {
         child->columnsOccupiedHeight[j] += copyRemainingItems[i]->height;
+        child->columnsDemand[j] -= copyRemainingItems[i]->height;
       }
       // fathoming criteria 2
       if (emptyItem &&
@@ -301,7 +375,7 @@ void StripPacking::BLEU::yCheckMakeBranch(
   }
 
   if (emptyItem) {
-    std::unique_ptr<BBNode> child(new BBNode(*t_currentNode));
+    auto child = t_pool.makeNode(*t_currentNode);
     for (size_t j = niche[0]; j <= niche[1]; ++j) {
       child->columnsOccupiedHeight[j] = std::min(l_niche, r_niche);
     }
@@ -371,6 +445,7 @@ StripPacking::BLEU::BBNode::BBNode(const BBNode& t_BBNode)
                                     // column, 3 is the largest index of...
   itemPositions = t_BBNode.itemPositions;
   packedItems = t_BBNode.packedItems;
+  columnsDemand = t_BBNode.columnsDemand;
 }
 
 // build a BBNode for the y check algorithm
@@ -388,6 +463,20 @@ StripPacking::BLEU::BBNode::BBNode(
                                      // column -> the right most column
   coordinate dummy(-1, -1);
   itemPositions = t_Cords;
+  // every item adds its height from its first column and removes it after
+  // its last one, the columns past t_Width are not counted
+  std::vector<int> difference(t_Width + 1, 0);
+  for (const auto& it : t_remainingItems) {
+    const int start = t_Cords[it->idxHelper].x;
+    difference[std::min(start, t_Width)] += it->height;
+    difference[std::min(start + it->width, t_Width)] -= it->height;
+  }
+  columnsDemand = std::vector<int>(t_Width, 0);
+  int demand = 0;
+  for (int i = 0; i < t_Width; ++i) {
+    demand += difference[i];
+    columnsDemand[i] = demand;
+  }
 }
 
 StripPacking::BLEU::BBNode::BBNode(
@@ -412,17 +501,109 @@ StripPacking::BLEU::BBNode::BBNode(
       t_BBNode.maxiItemIdxColumns;  // [3,5,1,7] means among items placed in 1st
                                     // column, 3 is the largest index of...
   itemPositions = t_BBNode.itemPositions;
+  columnsDemand = t_BBNode.columnsDemand;
+}
+
+void StripPacking::BLEU::BBNode::assign(const BBNode& t_BBNode) {
+  trialHeight = t_BBNode.trialHeight;
+  leftMostIdx = t_BBNode.leftMostIdx;
+  columnsOccupiedHeight = t_BBNode.columnsOccupiedHeight;
+  remainingItems = t_BBNode.remainingItems;
+  maxiItemIdxColumns = t_BBNode.maxiItemIdxColumns;
+  itemPositions = t_BBNode.itemPositions;
+  packedItems = t_BBNode.packedItems;
+  columnsDemand = t_BBNode.columnsDemand;
+}
+
+void StripPacking::BLEU::BBNode::assign(const BBNode& t_BBNode,
+                                        const item* t_placedItem) {
+  trialHeight = t_BBNode.trialHeight;
+  packedItems = t_BBNode.packedItems;
+  packedItems.push_back(t_placedItem);
+  remainingItems.clear();
+  for (const auto& it : t_BBNode.remainingItems) {
+    if (it->idx == t_placedItem->idx)
+      continue;
+    else
+      this->remainingItems.push_back(it);
+  }
+  leftMostIdx = t_BBNode.leftMostIdx;
+  columnsOccupiedHeight = t_BBNode.columnsOccupiedHeight;
+  maxiItemIdxColumns = t_BBNode.maxiItemIdxColumns;
+  itemPositions = t_BBNode.itemPositions;
+  columnsDemand = t_BBNode.columnsDemand;
+}
+
+void StripPacking::BLEU::BBNodeRecycler::operator()(BBNode* t_node) const {
+  pool->recycle(t_node);
+}
+
+StripPacking::BLEU::BBNodePtr StripPacking::BLEU::BBNodePool::makeNode(
+    const std::vector<const item*>& t_remainingItems, const int t_Width,
+    const int t_TrialHeight) {
+  std::unique_lock<std::mutex> guard(_lock, std::defer_lock);
+  if (_shared) guard.lock();
+  _nodes.emplace_back(t_remainingItems, t_Width, t_TrialHeight);
+  return BBNodePtr(&_nodes.back(), BBNodeRecycler(this));
+}
+
+StripPacking::BLEU::BBNodePtr StripPacking::BLEU::BBNodePool::makeNode(
+    const std::vector<const item*>& t_remainingItems,
+    const std::vector<coordinate>& t_Cords, const int t_Width,
+    const int t_TrialHeight) {
+  std::unique_lock<std::mutex> guard(_lock, std::defer_lock);
+  if (_shared) guard.lock();
+  _nodes.emplace_back(t_remainingItems, t_Cords, t_Width, t_TrialHeight);
+  return BBNodePtr(&_nodes.back(), BBNodeRecycler(this));
+}
+
+StripPacking::BLEU::BBNodePtr StripPacking::BLEU::BBNodePool::makeNode(
+    const BBNode& t_BBNode) {
+  std::unique_lock<std::mutex> guard(_lock, std::defer_lock);
+  if (_shared) guard.lock();
+  if (_freeNodes.empty()) {
+    _nodes.emplace_back(t_BBNode);
+    return BBNodePtr(&_nodes.back(), BBNodeRecycler(this));
+  }
+  BBNode* node = _freeNodes.back();
+  _freeNodes.pop_back();
+  if (guard.owns_lock()) guard.unlock();  // the copy needs no lock
+  node->assign(t_BBNode);
+  return BBNodePtr(node, BBNodeRecycler(this));
 }
 
-const bool StripPacking::BLEU::bounding(
-    const std::unique_ptr<BBNode>& t_currentNode) const {
+StripPacking::BLEU::BBNodePtr StripPacking::BLEU::BBNodePool::makeNode(
+    const BBNode& t_BBNode, const item* t_placedItem) {
+  std::unique_lock<std::mutex> guard(_lock, std::defer_lock);
+  if (_shared) guard.lock();
+  if (_freeNodes.empty()) {
+    _nodes.emplace_back(t_BBNode, t_placedItem);
+    return BBNodePtr(&_nodes.back(), BBNodeRecycler(this));
+  }
+  BBNode* node = _freeNodes.back();
+  _freeNodes.pop_back();
+  if (guard.owns_lock()) guard.unlock();  // the copy needs no lock
+  node->assign(t_BBNode, t_placedItem);
+  return BBNodePtr(node, BBNodeRecycler(this));
+}
+
+void StripPacking::BLEU::BBNodePool::recycle(BBNode* t_node) {
+  std::unique_lock<std::mutex> guard(_lock, std::defer_lock);
+  if (_shared) guard.lock();
+  _freeNodes.push_back(t_node);
+}
+
+const bool StripPacking::BLEU::bounding(const BBNode& t_currentNode,
+                                        DynamicCutCache& t_cache) const {
   // fathoming criteria 1
-  if (!t_currentNode->packedItems.empty()) {
-    const item* tmpItem = t_currentNode->packedItems.back();
-    for (const auto& it : t_currentNode->remainingItems) {
+  if (!t_currentNode.packedItems.empty()) {
+    const item* tmpItem = t_currentNode.packedItems.back();
+    for (const auto& it : t_currentNode.remainingItems) {
       if (it->height == tmpItem->height && it->width == tmpItem->width &&
-          it->idx < tmpItem->idx)
+          it->idx < tmpItem->idx) {
+        _context.statistics.fathom(BBIdenticalItems);
         return true;
+      }
     }
   }
   // fathoming criteria 2 is merged in the makeBranch function
@@ -430,35 +611,38 @@ const bool StripPacking::BLEU::bounding(
   // standard continuous bounding which is described in the section 5.2 "branch
   // and bound for the spp(L)" fathoming criteria 3
   int remainingArea = 0;
-  for (const auto& it : t_currentNode->remainingItems)
+  for (const auto& it : t_currentNode.remainingItems)
     remainingArea += it->height * it->width;
   int spaceArea = 0;
-  for (size_t i = 0; i < t_currentNode->columnsOccupiedHeight.size(); ++i)
+  for (size_t i = 0; i < t_currentNode.columnsOccupiedHeight.size(); ++i)
     spaceArea +=
-        (t_currentNode->trialHeight - t_currentNode->columnsOccupiedHeight[i]);
-  if (remainingArea > spaceArea) return true;
+        (t_currentNode.trialHeight - t_currentNode.columnsOccupiedHeight[i]);
+  if (remainingArea > spaceArea) {
+    _context.statistics.fathom(BBArea);
+    return true;
+  }
   // fathoming criteria 4
   // dynamic cuts:
-  if (this->dynamicCuts(t_currentNode)) {
-    BLEU::interestingStatics++;
+  if (this->dynamicCuts(t_currentNode, t_cache)) {
+    _context.interestingStatics++;
+    _context.statistics.fathom(BBDynamicCut);
     return true;
   }
   return false;
 }
 
-void StripPacking::BLEU::makeBranch(
-    const std::unique_ptr<BBNode>& t_currentNode,
-    std::stack<std::unique_ptr<BBNode>>& t_dfstree) const {
-  std::set<whPair> packedPairs;
-  std::list<std::unique_ptr<BBNode>> children;
-  std::list<std::unique_ptr<BBNode>> emptyChild;
+void StripPacking::BLEU::makeBranch(const BBNodePtr& t_currentNode,
+                                    std::stack<BBNodePtr>& t_dfstree,
+                                    BBNodePool& t_pool) const {
+  std::list<BBNodePtr> children;
+  std::list<BBNodePtr> emptyChild;
   // selects the left-most column
   int selectedColumn =
       t_currentNode->leftMostIdx;  // start from 0, so it ranges from 0,
                                    // 1,2,3,....., _processedW-1
   // pack nothing
   if (t_currentNode->columnsOccupiedHeight[selectedColumn] > 0) {
-    std::unique_ptr<BBNode> child(new BBNode(*t_currentNode.get()));
+    auto child = t_pool.makeNode(*t_currentNode);
     child->columnsOccupiedHeight[selectedColumn] = child->trialHeight;
     child->leftMostIdx++;
     emptyChild.push_back(std::move(child));
@@ -487,8 +671,7 @@ void StripPacking::BLEU::makeBranch(
         minHeight = copyRemainingItems[k]->height;
     }
     // make a child by pack the item on the column, update the coordinate
-    std::unique_ptr<BBNode> child(
-        new BBNode(*t_currentNode.get(), copyRemainingItems[i]));
+    auto child = t_pool.makeNode(*t_currentNode, copyRemainingItems[i]);
     child->itemPositions[chosenItem->idxHelper].x = selectedColumn;
     child->itemPositions[chosenItem->idxHelper].y =
         t_currentNode->columnsOccupiedHeight[selectedColumn];
@@ -515,71 +698,162 @@ void StripPacking::BLEU::makeBranch(
     t_dfstree.push(std::move((*it)));
 }
 
+const bool StripPacking::BLEU::checkpoint(const long long t_count,
+                                          const int t_depth) const {
+  if (t_count % SolverContext::checkInterval != 0)
+    return _context.stopFlag.load(std::memory_order_relaxed);
+  SearchProgress progress;
+  progress.depth = t_depth;
+  progress.trialHeight = _trialHeight;
+  progress.lowerBound = _bestLowerBound;
+  progress.upperBound = _bestUpperBound;
+  _context.reportProgress(progress);
+  return _context.timeUp();
+}
+
 const StripPacking::solutionStatus StripPacking::BLEU::branchAndBound(
     const std::vector<const item*>& t_Items, const int t_binWidth,
-    const int t_binHeight) {
+    const int t_binHeight, const searchStrategy t_strategy) {
   if (t_Items.empty()) return StripPacking::solutionStatus::feasible;
-  StripPacking::BLEU::nodeLimitFlag = false;
-  BLEU::algStatus = algorithmStatus::exact;
+  PhaseTimer timer(_context.statistics, branchAndBoundPhase);
+  _context.nodeLimitFlag = false;
+  _context.algStatus = algorithmStatus::exact;
   int tmpW = t_binWidth;
   int tmpH = t_binHeight;
-  BLEU::interestingStatics = 0;
+  _context.interestingStatics = 0;
   int maxExpNodes;
-  std::unique_ptr<BBNode> root(new BBNode(t_Items, tmpW, tmpH));
   double totalArea = 0.0;
   for (const auto& it : t_Items) totalArea += it->width * it->height;
   if (abs(tmpH - (totalArea / tmpW)) < BLEU::tolerance)
-    maxExpNodes = BLEU::BBMaxExplNodesPerPack;
+    maxExpNodes = _context.BBMaxExplNodesPerPack;
   else
-    maxExpNodes = BLEU::BBMaxExplNodesNonPerPack;
-  std::stack<std::unique_ptr<BBNode>> dfsTree;
-  dfsTree.push(std::move(root));
+    maxExpNodes = _context.BBMaxExplNodesNonPerPack;
+  if (_context.BBNumThreads > 1)
+    return this->branchAndBoundParallel(t_Items, tmpW, tmpH, maxExpNodes);
+  switch (t_strategy) {
+    case searchStrategy::bestFirst:
+      return this->bestFirstSearch(t_Items, tmpW, tmpH, maxExpNodes);
+    case searchStrategy::limitedDiscrepancy:
+      return this->limitedDiscrepancySearch(t_Items, tmpW, tmpH, maxExpNodes);
+    default:
+      break;
+  }
   int numberExploredNodes = 0;
-  while (!dfsTree.empty() && numberExploredNodes < maxExpNodes) {
-    const auto currentNode = std::move(dfsTree.top());
-    dfsTree.pop();
-    // if it's a feasible solution then invoke the y-check algorithm
-    if (currentNode->remainingItems.empty()) {
-      if (this->yCheckAlgorithm(tmpW, tmpH, currentNode->itemPositions,
-                                t_Items)) {
-        return solutionStatus::feasible;
-      } else
-        continue;  // the node can not be transformed to a feasible solution for
-                   // the SPP
-    } else {
-      // bounding the current Node
-      if (this->bounding(currentNode)) continue;
-      // make branch
-      numberExploredNodes++;
-      this->makeBranch(currentNode, dfsTree);
+  bool truncated = false;
+  return this->depthFirstSearch(t_Items, tmpW, tmpH, maxExpNodes, -1,
+                                numberExploredNodes, truncated);
+}
+
+/*
+Work-stealing version of branchAndBound with _context.BBNumThreads workers.
+Every worker runs the same DFS as the sequential version on its own deque and
+steals from the others when it runs dry. The explored-node counter is shared,
+so the node limit is the same as in the sequential search, and the first leaf
+accepted by the y-check stops all the workers.
+*/
+const StripPacking::solutionStatus StripPacking::BLEU::branchAndBoundParallel(
+    const std::vector<const item*>& t_Items, const int t_binWidth,
+    const int t_binHeight, const int t_maxExpNodes) {
+  const int numWorkers = _context.BBNumThreads;
+  // the workers share one pool since stolen nodes die on another thread; it is
+  // declared first so that it outlives the queues
+  BBNodePool pool(true);
+  std::vector<BBWorkerQueue> queues(numWorkers);
+  queues[0].nodes.push_back(pool.makeNode(t_Items, t_binWidth, t_binHeight));
+  std::atomic<int> outstandingNodes(1);  // nodes queued or being processed
+  std::atomic<int> numberExploredNodes(0);
+  std::atomic<bool> found(false);
+  std::atomic<bool> limitReached(false);
+  std::atomic<bool> stop(false);
+  auto worker = [&](const int t_id) {
+    std::stack<BBNodePtr> children;
+    std::vector<BBNodePtr> buffer;
+    DynamicCutCache cutCache;
+    while (!stop.load()) {
+      BBNodePtr currentNode;
+      {
+        std::lock_guard<std::mutex> guard(queues[t_id].lock);
+        if (!queues[t_id].nodes.empty()) {
+          currentNode = std::move(queues[t_id].nodes.back());
+          queues[t_id].nodes.pop_back();
+        }
+      }
+      for (int k = 1; !currentNode && k < numWorkers; ++k) {
+        auto& victim = queues[(t_id + k) % numWorkers];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.nodes.empty()) {
+          currentNode = std::move(victim.nodes.front());
+          victim.nodes.pop_front();
+        }
+      }
+      if (!currentNode) {
+        if (outstandingNodes.load() == 0) break;  // the tree is exhausted
+        std::this_thread::yield();
+        continue;
+      }
+      if (currentNode->remainingItems.empty()) {
+        if (this->yCheckAlgorithm(t_binWidth, t_binHeight,
+                                  currentNode->itemPositions, t_Items)) {
+          found.store(true);
+          stop.store(true);
+        }
+      } else if (!this->bounding(*currentNode, cutCache)) {
+        _context.exploredNodes++;
+        const int count = numberExploredNodes.fetch_add(1) + 1;
+        if (count >= t_maxExpNodes ||
+            this->checkpoint(count, int(currentNode->packedItems.size()))) {
+          limitReached.store(true);
+          stop.store(true);
+        }
+        this->makeBranch(currentNode, children, pool);
+        // keep the sequential order: the top of the stack goes to the back
+        buffer.clear();
+        while (!children.empty()) {
+          buffer.push_back(std::move(children.top()));
+          children.pop();
+        }
+        outstandingNodes.fetch_add(int(buffer.size()));
+        std::lock_guard<std::mutex> guard(queues[t_id].lock);
+        for (auto it = buffer.rbegin(); it != buffer.rend(); ++it)
+          queues[t_id].nodes.push_back(std::move(*it));
+        SolverStatistics::updateMax(_context.statistics.BBMaxStackSize,
+                                    queues[t_id].nodes.size());
+      }
+      outstandingNodes.fetch_sub(1);
     }
-  }
-  if (numberExploredNodes >= maxExpNodes) {
-    return solutionStatus::pending;
-  } else
-    return solutionStatus::infeasible;
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < numWorkers; ++i) threads.emplace_back(worker, i);
+  worker(0);
+  for (auto& it : threads) it.join();
+  if (found.load()) return solutionStatus::feasible;
+  if (limitReached.load() || _context.stopFlag) return solutionStatus::pending;
+  return solutionStatus::infeasible;
 }
 
 const StripPacking::solutionStatus StripPacking::BLEU::branchAndBoundYRelax(
     const std::vector<const item*>& t_Items, const int t_binWidth,
     const int t_binHeight) {
   if (t_Items.empty()) return StripPacking::solutionStatus::feasible;
-  StripPacking::BLEU::nodeLimitFlag = false;
+  _context.nodeLimitFlag = false;
   int tmpW = t_binWidth;
   int tmpH = t_binHeight;
-  BLEU::interestingStatics = 0;
+  _context.interestingStatics = 0;
   int maxExpNodes;
-  std::unique_ptr<BBNode> root(new BBNode(t_Items, tmpW, tmpH));
+  BBNodePool pool;
   double totalArea = 0.0;
   for (const auto& it : t_Items) totalArea += it->width * it->height;
   if (abs(tmpH - (totalArea / tmpW)) < BLEU::tolerance)
-    maxExpNodes = BLEU::BBMaxExplNodesPerPack;
+    maxExpNodes = _context.BBMaxExplNodesPerPack;
   else
-    maxExpNodes = BLEU::BBMaxExplNodesNonPerPack;
-  std::stack<std::unique_ptr<BBNode>> dfsTree;
-  dfsTree.push(std::move(root));
+    maxExpNodes = _context.BBMaxExplNodesNonPerPack;
+  std::stack<BBNodePtr> dfsTree;
+  dfsTree.push(pool.makeNode(t_Items, tmpW, tmpH));
+  DynamicCutCache cutCache;
   int numberExploredNodes = 0;
   while (!dfsTree.empty() && numberExploredNodes < maxExpNodes) {
+    SolverStatistics::updateMax(_context.statistics.BBMaxStackSize,
+                                dfsTree.size());
     const auto currentNode = std::move(dfsTree.top());
     dfsTree.pop();
     // if it's a feasible solution return
@@ -587,31 +861,67 @@ const StripPacking::solutionStatus StripPacking::BLEU::branchAndBoundYRelax(
       return solutionStatus::feasible;
     } else {
       // bounding the current Node
-      if (this->bounding(currentNode)) continue;
+      if (this->bounding(*currentNode, cutCache)) continue;
       // make branch
       numberExploredNodes++;
-      this->makeBranch(currentNode, dfsTree);
+      _context.exploredNodes++;
+      if (this->checkpoint(numberExploredNodes,
+                           int(currentNode->packedItems.size())))
+        break;
+      this->makeBranch(currentNode, dfsTree, pool);
     }
   }
-  if (numberExploredNodes >= maxExpNodes) {
+  if (numberExploredNodes >= maxExpNodes || _context.stopFlag) {
     return solutionStatus::pending;
   } else
     return solutionStatus::infeasible;
 }
 
-const bool StripPacking::BLEU::dynamicCuts(
-    const std::unique_ptr<BBNode>& t_currentNode) const {
-  std::list<coordinate> leftCorners;
-  int prev = t_currentNode->trialHeight;
-  for (size_t i = 0; i < t_currentNode->columnsOccupiedHeight.size(); ++i) {
-    if (prev > t_currentNode->columnsOccupiedHeight[i]) {
-      coordinate cords(i, t_currentNode->columnsOccupiedHeight[i]);
-      leftCorners.push_back(cords);
-    }
-    prev = t_currentNode->columnsOccupiedHeight[i];
+void StripPacking::BLEU::DynamicCutCache::update(
+    const std::vector<const item*>& t_remainingItems,
+    const int t_widthCapacity, const int t_heightCapacity) {
+  if (t_widthCapacity != widthCapacity || t_heightCapacity != heightCapacity) {
+    widthCapacity = t_widthCapacity;
+    heightCapacity = t_heightCapacity;
+    widthWords = subsetSumWords(widthCapacity);
+    heightWords = subsetSumWords(heightCapacity);
+    validRows = 0;
   }
-  bool result = false;
-  size_t tmpSize = leftCorners.size();
+  size_t sharedRows = 0;
+  while (sharedRows < validRows && sharedRows < t_remainingItems.size() &&
+         items[sharedRows] == t_remainingItems[sharedRows])
+    ++sharedRows;
+  validRows = sharedRows;
+  items = t_remainingItems;
+  if (widthRows.size() < items.size() * widthWords)
+    widthRows.resize(items.size() * widthWords);
+  if (heightRows.size() < items.size() * heightWords)
+    heightRows.resize(items.size() * heightWords);
+}
+
+void StripPacking::BLEU::DynamicCutCache::computeRow(const size_t t_row) {
+  auto fill = [t_row](std::vector<std::uint64_t>& t_rows,
+                      const size_t t_numWords, const int t_capacity,
+                      const int t_weight) {
+    std::uint64_t* row = t_rows.data() + t_row * t_numWords;
+    if (t_row == 0) {
+      std::fill(row, row + t_numWords, 0);
+      row[0] = 1;  // the empty subset
+    } else
+      std::copy(row - t_numWords, row, row);
+    if (t_weight <= t_capacity)
+      subsetSumShiftOr(row, row, t_numWords, t_weight);
+  };
+  fill(widthRows, widthWords, widthCapacity, items[t_row]->width);
+  fill(heightRows, heightWords, heightCapacity, items[t_row]->height);
+  validRows = t_row + 1;
+}
+
+const bool StripPacking::BLEU::dynamicCuts(const BBNode& t_currentNode,
+                                           DynamicCutCache& t_cache) const {
+  const int binWidth = t_currentNode.columnsOccupiedHeight.size();
+  const int trialHeight = t_currentNode.trialHeight;
+  t_cache.update(t_currentNode.remainingItems, binWidth, trialHeight);
   /*
   s[i][0]: the width of the i^th stage,
   s[i][1]: the height of the i^th stage
@@ -620,139 +930,92 @@ const bool StripPacking::BLEU::dynamicCuts(
   l[i][0]: the realizable maximal width
   l[i][1]: the realizable maximal height
   */
-  int** s = new int*[tmpSize];
-  int** g = new int*[tmpSize];
-  int** l = new int*[tmpSize];
-  for (size_t i = 0; i < tmpSize; ++i) {
-    s[i] = new int[2];
-    g[i] = new int[2];
-    l[i] = new int[2];
-  }
-  int i = 0;
-  int tmpXPrev = -1;  // store the x coordinate of the previous left corner
-  int tmpYPrev = -1;  // store the y coordinate of the previous left corner
+  auto& s0 = t_cache.s0;
+  auto& s1 = t_cache.s1;
+  auto& g0 = t_cache.g0;
+  auto& g1 = t_cache.g1;
+  auto& l0 = t_cache.l0;
+  auto& l1 = t_cache.l1;
+  auto& B = t_cache.B;
+  s0.clear();
+  s1.clear();
+  g0.clear();
+  g1.clear();
   /*
   At each left corner, the length can be updated for the onging left corner,
   while the width can only be updated by the upcoming left corner
   */
-  for (std::list<coordinate>::const_iterator iter = leftCorners.begin();
-       iter != leftCorners.end(); ++iter) {
-    g[i][0] = t_currentNode->maxiItemIdxColumns.size() - (*iter).x;
-    g[i][1] = t_currentNode->trialHeight - (*iter).y;
-    if (tmpXPrev == -1) {
-      tmpXPrev = (*iter).x;
-      tmpYPrev = (*iter).y;
-      s[i][1] = t_currentNode->trialHeight - (*iter).y;
-    } else {
-      s[i - 1][0] = (*iter).x - tmpXPrev;
-      s[i][1] = tmpYPrev - (*iter).y;
-      tmpXPrev = (*iter).x;
-      tmpYPrev = (*iter).y;
+  int prev = trialHeight;
+  int tmpXPrev = -1;  // store the x coordinate of the previous left corner
+  int tmpYPrev = -1;  // store the y coordinate of the previous left corner
+  for (int x = 0; x < binWidth; ++x) {
+    const int y = t_currentNode.columnsOccupiedHeight[x];
+    if (prev > y) {
+      g0.push_back(binWidth - x);
+      g1.push_back(trialHeight - y);
+      if (tmpXPrev == -1) {
+        s1.push_back(trialHeight - y);
+      } else {
+        s0.push_back(x - tmpXPrev);
+        s1.push_back(tmpYPrev - y);
+      }
+      tmpXPrev = x;
+      tmpYPrev = y;
     }
-    if (i == tmpSize - 1)
-      s[i][0] = t_currentNode->maxiItemIdxColumns.size() - (*iter).x;
-    ++i;
+    prev = y;
   }
+  const size_t tmpSize = g0.size();
+  if (tmpSize > 0) s0.push_back(binWidth - tmpXPrev);
+  l0.resize(tmpSize);
+  l1.resize(tmpSize);
 
   /*
   compute the remaining available area (in the paper, it is denoted as V_pi)
   */
   int vPi = 0;
-  for (size_t i = 0; i < tmpSize; ++i) vPi += g[i][1] * s[i][0];
+  for (size_t i = 0; i < tmpSize; ++i) vPi += g1[i] * s0[i];
 
   /*
-  preapre the onedimensional items for running the DP
+  calculate the values for matrix l
   */
-  std::vector<const oneDimensionItem*> oneDim4HeightVec;
-  std::vector<const oneDimensionItem*> oneDim4WidthVec;
+  const size_t numberItems = t_currentNode.remainingItems.size();
   int accumulatedArea = 0;  // accumulated Area of the items considered so far
-  for (std::vector<const item*>::const_iterator iter =
-           t_currentNode->remainingItems.begin();
-       iter != t_currentNode->remainingItems.end(); ++iter) {
-    const oneDimensionItem* oneDimItemH =
-        new oneDimensionItem((*iter)->height, (*iter)->height);
-    const oneDimensionItem* oneDimItemW =
-        new oneDimensionItem((*iter)->width, (*iter)->width);
-    oneDim4HeightVec.push_back(oneDimItemH);
-    oneDim4WidthVec.push_back(oneDimItemW);
-  }
-  std::vector<std::vector<int>> l0ValueOverItems;
-  std::vector<std::vector<int>> l1ValueOverItems;
-  for (size_t i = 0; i < tmpSize; ++i) {
-    l0ValueOverItems.push_back(
-        dynamicPrg4KnapSack<oneDimensionItem>(oneDim4WidthVec, g[i][0], 0));
-    l1ValueOverItems.push_back(
-        dynamicPrg4KnapSack<oneDimensionItem>(oneDim4HeightVec, g[i][1], 0));
-  }
-  /*
-          calculate the values for matrix l
-          */
-  for (size_t j = 0; j < t_currentNode->remainingItems.size(); ++j) {
-    accumulatedArea += t_currentNode->remainingItems[j]->height *
-                       t_currentNode->remainingItems[j]->width;
+  for (size_t j = 0; j < numberItems; ++j) {
+    accumulatedArea += t_currentNode.remainingItems[j]->height *
+                       t_currentNode.remainingItems[j]->width;
+    if (j >= t_cache.validRows) t_cache.computeRow(j);
     int A = 0;
     int sum_B = 0;
-    std::vector<int> B;
     B.clear();
     for (size_t i = 0; i < tmpSize; ++i) {
-      l[i][0] = l0ValueOverItems[i][j];
-      l[i][1] = l1ValueOverItems[i][j];
+      l0[i] = t_cache.maxWidth(j, g0[i]);
+      l1[i] = t_cache.maxHeight(j, g1[i]);
     }
     for (size_t i = 0; i < tmpSize; ++i) {
-      A += s[i][0] * (g[i][1] - l[i][1]) + s[i][1] * (g[i][0] - l[i][0]) -
-           (g[i][1] - l[i][1]) * (g[i][0] - l[i][0]);
+      A += s0[i] * (g1[i] - l1[i]) + s1[i] * (g0[i] - l0[i]) -
+           (g1[i] - l1[i]) * (g0[i] - l0[i]);
       if (i < tmpSize - 1) {
-        A += (g[i][1] - l[i][1]) * (g[i + 1][0] - l[i + 1][0]);
+        A += (g1[i] - l1[i]) * (g0[i + 1] - l0[i + 1]);
       }
-      if (t_currentNode->remainingItems.size() < tmpSize) {
+      if (numberItems < tmpSize) {
         if (i == 0)
-          B.push_back((g[1][0] - l[1][0] + s[0][0] - g[0][0] + l[0][0]) *
-                      (s[0][1] - g[0][1] + l[0][1]));
+          B.push_back((g0[1] - l0[1] + s0[0] - g0[0] + l0[0]) *
+                      (s1[0] - g1[0] + l1[0]));
         if (i == tmpSize - 1)
-          B.push_back(
-              (s[i][0] - g[i][0] + l[i][0]) *
-              (g[i - 1][1] - l[i - 1][1] + s[i][1] - g[i][1] + l[i][1]));
+          B.push_back((s0[i] - g0[i] + l0[i]) *
+                      (g1[i - 1] - l1[i - 1] + s1[i] - g1[i] + l1[i]));
         if (i > 0 && i < tmpSize - 1)
-          B.push_back(
-              (g[i + 1][0] - l[i + 1][0] + s[i][0] - g[i][0] + l[i][0]) *
-              (g[i - 1][1] - l[i - 1][1] + s[i][1] - g[i][1] + l[i][1]));
+          B.push_back((g0[i + 1] - l0[i + 1] + s0[i] - g0[i] + l0[i]) *
+                      (g1[i - 1] - l1[i - 1] + s1[i] - g1[i] + l1[i]));
       }
     }
     if (!B.empty()) {
       std::sort(B.begin(), B.end());
-      for (size_t k = 0;
-           k < leftCorners.size() - t_currentNode->remainingItems.size(); ++k) {
-        sum_B += B[k];
-      }
+      for (size_t k = 0; k < tmpSize - numberItems; ++k) sum_B += B[k];
     }
-    if (vPi - (A + sum_B) < accumulatedArea) {
-      result = true;
-      break;
-    }
-  }
-
-  /*
-  Release the heap
-  */
-  {
-    for (size_t i = 0; i < tmpSize; ++i) {
-      delete[] s[i];
-      delete[] g[i];
-      delete[] l[i];
-    }
-    delete[] s;
-    delete[] g;
-    delete[] l;
-    for (std::vector<const oneDimensionItem*>::iterator iter =
-             oneDim4HeightVec.begin();
-         iter != oneDim4HeightVec.end(); ++iter)
-      delete (*iter);
-    for (std::vector<const oneDimensionItem*>::iterator iter =
-             oneDim4WidthVec.begin();
-         iter != oneDim4WidthVec.end(); ++iter)
-      delete (*iter);
+    if (vPi - (A + sum_B) < accumulatedArea) return true;
   }
-  return result;
+  return false;
 }
 
 // The branch and bound algorithm
@@ -775,6 +1038,7 @@ void StripPacking::BLEU::cutItemsAlongHeight() {
 5.1 the three preprocessing procedures
 */
 void StripPacking::BLEU::preprocessing() {
+  PhaseTimer timer(_context.statistics, preprocessingPhase);
   this->preprocessingFixItems();
   this->preprocessingReduceW();
   this->preprocessingModifyItemWidth();
@@ -816,19 +1080,11 @@ modify width for items according to 2.2.3 in the paper "An exact algorithm for
 the two-dimensional strip packing problem"
 */
 void StripPacking::BLEU::preprocessingModifyItemWidth() {
-  for (std::vector<const item*>::iterator i_it = _processedItems.begin();
-       i_it != _processedItems.end(); ++i_it) {
-    std::vector<int> integers;
-    for (auto& j_it : _processedItems) {
-      if ((*i_it)->idx == j_it->idx) continue;
-      integers.push_back(j_it->width);
-    }
-    int maxWidth =
-        subSetSum(integers, _processedW - (*i_it)->width) + (*i_it)->width;
-    if (maxWidth < _processedW)
-      const_cast<item*>((*i_it))->width =
-          (*i_it)->width + _processedW - maxWidth;
-  }
+  std::vector<int> widths;
+  for (const auto& it : _processedItems) widths.push_back(it->width);
+  widths = liftWeights(widths, _processedW);
+  for (size_t i = 0; i < _processedItems.size(); ++i)
+    const_cast<item*>(_processedItems[i])->width = widths[i];
 }
 
 /*
@@ -838,18 +1094,10 @@ idx is also changed) 2) modify the bin width
 void StripPacking::BLEU::preprocessItemHeight(std::vector<item*>& t_items,
                                               const int t_binHeight,
                                               int& t_binWidth) {
-  for (auto& i_it : t_items) {
-    std::vector<int> integers;
-    for (auto& j_it : t_items) {
-      if (i_it->idx == j_it->idx) continue;
-      integers.push_back(j_it->height);
-    }
-    int maxHeight =
-        subSetSum(integers, t_binHeight - i_it->height) + (i_it)->height;
-    if (maxHeight < t_binHeight) {
-      (i_it)->height = (i_it)->height + t_binHeight - maxHeight;
-    }
-  }
+  std::vector<int> heights;
+  for (const auto& it : t_items) heights.push_back(it->height);
+  heights = liftWeights(heights, t_binHeight);
+  for (size_t i = 0; i < t_items.size(); ++i) t_items[i]->height = heights[i];
   int minHeight = BigNumber;
   for (const auto& it : t_items) {
     if (minHeight > it->height) minHeight = it->height;
@@ -871,19 +1119,51 @@ void StripPacking::BLEU::preprocessItemHeight(std::vector<item*>& t_items,
 }
 
 /*
-section 5.1 lower bounds plus upper bounds
+best height of the best-fit heuristic and of the iterated greedy, computed on
+all the items (the widths enlarged by the preprocessing stay packable)
+*/
+const int StripPacking::BLEU::heuristicUpperBound() {
+  Heuristic heuristic(_context);
+  std::vector<const item*> items(_allItems);
+  int upperBound = heuristic.bestFitHeuristic(items, _W);
+  if (upperBound > _bestLowerBound) {
+    items = _allItems;
+    upperBound = std::min(upperBound, heuristic.iteratedGreedy(items, _W));
+  }
+  return upperBound;
+}
+
+/*
+section 5.1 lower bounds plus upper bounds. The bounds are computed from the
+cheapest to the most expensive and the cascade stops as soon as the lower bound
+proves the trial height infeasible or meets the upper bound, the remaining ones
+could not change the answer. In optimize mode the best-fit height is computed
+before the LPs, as it may already meet the lower bound.
 */
 void StripPacking::BLEU::bounds() {
-  int lb1 = this->LowerBound1();
-  int lb2 = this->LowerBound2();
-  int lb4 = this->LowerBound4();
-  _bestLowerBound = std::max({lb1, lb2, lb4});
-  int lb3 = this->LowerBound3();
-  int lb5 = this->LowerBound5();
-  _bestLowerBound = std::max({_bestLowerBound, lb3, lb5});
+  typedef const int (BLEU::*lowerBoundFunction)() const;
+  const lowerBoundFunction cascade[numberLowerBoundKind] = {
+      &BLEU::LowerBound1, &BLEU::LowerBound2, &BLEU::LowerBound3,
+      &BLEU::LowerBound4, &BLEU::LowerBound5};
+  for (int k = 0; k < numberLowerBoundKind; ++k) {
+    if (k == lowerBoundKind::boundLB4 && !_evaluatedMode) {
+      Heuristic heuristic(_context);
+      std::vector<const item*> items(_allItems);
+      _bestUpperBound = heuristic.bestFitHeuristic(items, _W);
+      if (_bestLowerBound >= _bestUpperBound) return;
+    }
+    const int lowerBound = (this->*cascade[k])();
+    if (lowerBound > _bestLowerBound) {
+      _bestLowerBound = lowerBound;
+      _decidingBound = lowerBoundKind(k);
+    }
+    if (_evaluatedMode && _bestLowerBound > _trialHeight) return;
+    if (_bestUpperBound >= 0 && _bestLowerBound >= _bestUpperBound) return;
+  }
 }
 
 const int StripPacking::BLEU::LowerBound1() const {
+  PhaseTimer timer(_context.statistics, lowerBound1Phase);
   int sum = 0;
   for (const auto& it : _processedItems) {
     sum += it->height * it->width;
@@ -898,47 +1178,26 @@ of dual feasible functions, refer to the paper : "New  classes of fast lower
 bounds  for  bin  packingproblems"
 */
 const int StripPacking::BLEU::LowerBound2() const {
-  // dual feasible function 1:
-  int lowerBound = 0;
-  for (size_t alpha = 1; alpha <= _processedW; ++alpha) {
-    std::vector<double> allTransformedWidths;
-    for (const auto& it : _processedItems)
-      allTransformedWidths.push_back(
-          this->DualFeasibleFunction1(alpha, it->width));
-    double sum = 0.0;
-    for (size_t i = 0; i < _processedItems.size(); i++)
-      sum += allTransformedWidths[i] * _processedItems[i]->height;
-    if (lowerBound < std::ceil(sum / _processedW))
-      lowerBound = std::ceil(sum / _processedW);
-  }
-  // dual feasible function 2:
-  for (size_t alpha = 1; alpha <= std::floor(_processedW / 2); ++alpha) {
-    std::vector<double> allTransformedWidths;
-    for (const auto& it : _processedItems)
-      allTransformedWidths.push_back(
-          this->DualFeasibleFunction2(alpha, it->width));
-    double sum = 0.0;
-    for (size_t i = 0; i < _processedItems.size(); i++)
-      sum += allTransformedWidths[i] * _processedItems[i]->height;
-    auto candidate =
-        std::ceil(sum / this->DualFeasibleFunction2(alpha, _processedW));
-    if (lowerBound < candidate) lowerBound = candidate;
-  }
-
-  // dual feasible function 3:
-  for (size_t alpha = 1; alpha <= std::floor(_processedW / 2); ++alpha) {
-    std::vector<double> allTransformedWidths;
-    for (const auto& it : _processedItems)
-      allTransformedWidths.push_back(
-          this->DualFeasibleFunction3(alpha, it->width));
-    double sum = 0.0;
-    for (size_t i = 0; i < _processedItems.size(); i++)
-      sum += allTransformedWidths[i] * _processedItems[i]->height;
-    auto candidate =
-        std::ceil(sum / this->DualFeasibleFunction3(alpha, _processedW));
-    if (lowerBound < candidate) lowerBound = candidate;
+  PhaseTimer timer(_context.statistics, lowerBound2Phase);
+  if (_processedItems.empty()) return _processedH;
+  // the items of the same width count as one, with the sum of their heights
+  std::vector<std::pair<int, int>> sizes;
+  for (const auto& it : _processedItems)
+    sizes.push_back(std::make_pair(it->width, it->height));
+  std::sort(sizes.begin(), sizes.end());
+  std::vector<int> widths;
+  std::vector<long long> heights;
+  for (const auto& it : sizes) {
+    if (widths.empty() || widths.back() != it.first) {
+      widths.push_back(it.first);
+      heights.push_back(0);
+    }
+    heights.back() += it.second;
   }
-  return lowerBound + _processedH;
+  // the cheap ones first, they cut the alphas of the first one
+  const int lowerBound = std::max(this->DualFeasibleBound2(widths, heights),
+                                  this->DualFeasibleBound3(widths, heights));
+  return this->DualFeasibleBound1(widths, heights, lowerBound) + _processedH;
 }
 
 /*
@@ -947,71 +1206,127 @@ Alvarez-Vales R, Parreno F, Tamarit JM. A branch and bound algorithm for the
 strip packing problem. OR spectrum. 2009 Apr 1;31(2):431-59. Section 4.2.6
 */
 const int StripPacking::BLEU::LowerBound3() const {
+  PhaseTimer timer(_context.statistics, lowerBound3Phase);
   // step 1:
   if (_processedItems.empty()) return _bestLowerBound;
-  bool exitFlag = false;
-  int result;
-  for (int k = 0; !exitFlag; k++) {
-    int RectangleW = _processedW;
-    int RectangleH = _bestLowerBound + k;
-    std::vector<item*> itemsArr;
-    for (const auto& it : _processedItems) {
-      item* tmp = new item(*it);
-      itemsArr.push_back(tmp);
+  const int n = int(_processedItems.size());
+  // scratch of the packings, reused over the heights
+  std::vector<int> widths(n), heights(n), keys(n), heap, position(n);
+  std::vector<int> removed, changed;
+  /*
+  Steps 1 to 3 on a rectangle of height t_height. The heap keeps the item
+  with the smallest min(W - width, H - height) on top, ties by index. Packing
+  an item at the bottom (left) leaves the key of the items it shrinks
+  unchanged and decreases the key of the others, which are sifted up.
+  */
+  auto fits = [&](const int t_height) {
+    int rectangleW = _processedW;
+    int rectangleH = t_height;
+    auto before = [&keys](const int t_i, const int t_j) {
+      return keys[t_i] < keys[t_j] || (keys[t_i] == keys[t_j] && t_i < t_j);
+    };
+    auto siftUp = [&](int t_at) {
+      const int i = heap[t_at];
+      while (t_at > 0 && before(i, heap[(t_at - 1) / 2])) {
+        heap[t_at] = heap[(t_at - 1) / 2];
+        position[heap[t_at]] = t_at;
+        t_at = (t_at - 1) / 2;
+      }
+      heap[t_at] = i;
+      position[i] = t_at;
+    };
+    auto siftDown = [&](int t_at) {
+      const int i = heap[t_at];
+      const int size = int(heap.size());
+      while (2 * t_at + 1 < size) {
+        int child = 2 * t_at + 1;
+        if (child + 1 < size && before(heap[child + 1], heap[child])) ++child;
+        if (!before(heap[child], i)) break;
+        heap[t_at] = heap[child];
+        position[heap[t_at]] = t_at;
+        t_at = child;
+      }
+      heap[t_at] = i;
+      position[i] = t_at;
+    };
+    auto erase = [&](const int t_i) {
+      const int at = position[t_i];
+      const int last = heap.back();
+      heap.pop_back();
+      if (last == t_i) return;
+      heap[at] = last;
+      position[last] = at;
+      siftUp(at);
+      siftDown(position[last]);
+    };
+    heap.clear();
+    for (int i = 0; i < n; ++i) {
+      widths[i] = _processedItems[i]->width;
+      heights[i] = _processedItems[i]->height;
+      keys[i] = std::min(rectangleW - widths[i], rectangleH - heights[i]);
+      heap.push_back(i);
+      siftUp(i);
     }
-    while (true) {
-      std::make_heap(itemsArr.begin(), itemsArr.end(),
-                     compareItemByWHDifference(RectangleH, RectangleW));
-      std::pop_heap(itemsArr.begin(), itemsArr.end(),
-                    compareItemByWHDifference(RectangleH, RectangleW));
-      item* selectedItem = itemsArr.back();
-      itemsArr.pop_back();
+    while (!heap.empty()) {
+      const int selected = heap.front();
+      erase(selected);
       // check if the item can fit the rectangle
-      if (selectedItem->height > RectangleH && selectedItem->width > RectangleW)
-        break;
-      std::set<int> removedItems;
-      // step 2 and step 3
-      if (RectangleW - selectedItem->width <=
-          RectangleH - selectedItem->height) {
-        // pack the item at the bottom and update the rectangle and width of
-        // some items
-        RectangleH -= selectedItem->height;
-        for (size_t i = 0; i < itemsArr.size(); ++i) {
-          if (itemsArr[i]->width <= RectangleW - selectedItem->width) {
-            itemsArr[i]->height =
-                std::max(0, itemsArr[i]->height - selectedItem->height);
-            if (itemsArr[i]->height == 0) removedItems.insert(itemsArr[i]->idx);
-          }
-        }
-      } else {
-        // pack the item at the left
-        RectangleW -= selectedItem->width;
-        for (size_t i = 0; i < itemsArr.size(); ++i) {
-          if (itemsArr[i]->height <= RectangleH - selectedItem->height) {
-            itemsArr[i]->width =
-                std::max(0, itemsArr[i]->width - selectedItem->width);
-            if (itemsArr[i]->width == 0) removedItems.insert(itemsArr[i]->idx);
-          }
+      if (heights[selected] > rectangleH && widths[selected] > rectangleW)
+        return false;
+      // step 2 and step 3, pack the item at the bottom and update the
+      // heights of some items, or at the left and update their widths
+      const bool bottom =
+          rectangleW - widths[selected] <= rectangleH - heights[selected];
+      if (bottom)
+        rectangleH -= heights[selected];
+      else
+        rectangleW -= widths[selected];
+      removed.clear();
+      changed.clear();
+      for (const int i : heap) {
+        if (bottom && widths[i] <= rectangleW - widths[selected]) {
+          heights[i] = std::max(0, heights[i] - heights[selected]);
+          if (heights[i] == 0) removed.push_back(i);
+        } else if (!bottom &&
+                   heights[i] <= rectangleH - heights[selected]) {
+          widths[i] = std::max(0, widths[i] - widths[selected]);
+          if (widths[i] == 0) removed.push_back(i);
+        } else {
+          changed.push_back(i);
         }
       }
-      std::vector<item*> remainingItemsArr;
-      for (size_t i = 0; i < itemsArr.size(); ++i) {
-        if (removedItems.find(itemsArr[i]->idx) == removedItems.end())
-          remainingItemsArr.push_back(itemsArr[i]);
-        else
-          delete itemsArr[i];
-      }
-      if (remainingItemsArr.empty())  // means all the items are packed
-      {
-        exitFlag = true;
-        result = _bestLowerBound + k;
-        break;
+      // the keys are still those of the heap when erasing, then they only
+      // decrease
+      for (const int i : removed) erase(i);
+      for (const int i : changed) {
+        keys[i] = std::min(rectangleW - widths[i], rectangleH - heights[i]);
+        siftUp(position[i]);
       }
-      itemsArr.clear();
-      itemsArr.assign(remainingItemsArr.begin(), remainingItemsArr.end());
     }
+    return true;  // all the items are packed
+  };
+  /*
+  The smallest height the packing accepts, by exponential search and
+  bisection from _bestLowerBound. A rejected height is infeasible, and so are
+  the smaller ones, hence the bound even where the acceptance of the packing
+  is not monotone.
+  */
+  if (fits(_bestLowerBound)) return _bestLowerBound;
+  int rejected = 0;  // the largest k known to be rejected
+  int step = 1;
+  while (!fits(_bestLowerBound + rejected + step)) {
+    rejected += step;
+    step *= 2;
   }
-  return result;
+  int accepted = rejected + step;
+  while (accepted - rejected > 1) {
+    const int k = rejected + (accepted - rejected) / 2;
+    if (fits(_bestLowerBound + k))
+      accepted = k;
+    else
+      rejected = k;
+  }
+  return _bestLowerBound + accepted;
 }
 
 /*
@@ -1019,101 +1334,48 @@ Section 5.1
 Solve a noncontiguous packing problem (NCBP)
 */
 const int StripPacking::BLEU::LowerBound4() const {
+  PhaseTimer timer(_context.statistics, lowerBound4Phase);
+  // the master of a previous call, or a new one with the pooled columns
+  auto& master = *_context.NCBP;
+  if (!master.prepare(_processedItems, _processedW, _context.LPBackend))
+    return 0;
+  auto& lp = master.lp();
   std::vector<int> allWidths;
-  int colIdx = 0;
-  // initialize columns
-  std::list<std::set<int>> columns;  // a collection of columns		a column
-                                     // is a set of item index
-  for (size_t i = 0; i < _processedItems.size(); ++i) {
-    std::set<int> tmp;
-    tmp.insert(_processedItems[i]->idx);
-    columns.push_back(tmp);
-    allWidths.push_back(_processedItems[i]->width);
-  }
-  // model the LP
-  IloEnv env;
-  IloModel NCBP(env);
-  std::map<int, IloRange> allCstrs;
-  // add constraints
-  for (size_t i = 0; i < _processedItems.size(); ++i) {
-    char nameCstr[64];
-    sprintf_s(nameCstr, 64, "Cstr %d", _processedItems[i]->idx);
-    IloExpr expr(env);
-    IloRange cstr(env, _processedItems[i]->height, expr, IloInfinity, nameCstr);
-    allCstrs.insert(std::pair<int, IloRange>(_processedItems[i]->idx, cstr));
-    NCBP.add(cstr);
-    expr.end();
-  }
-  // add the variables and the objective function
-  IloExpr obj(env);
-  for (const auto& i_it : columns) {
-    IloNumColumn col(env);
-    for (const auto& j_it : i_it) {
-      auto ptr = allCstrs.find(j_it);
-      if (ptr != allCstrs.end()) col += ptr->second(1);
-    }
-    char varName[64];
-    sprintf_s(varName, 64, "Var %d", colIdx++);
-    IloNumVar var(col);
-    var.setName(varName);
-    var.setBounds(0, +IloInfinity);
-    NCBP.add(var);
-    col.end();
-    obj += var;
-  }
-  IloObjective realObj = IloMinimize(env, obj);
-  NCBP.add(realObj);
-  obj.end();
-  try {
-    IloCplex cplex(NCBP);
-    cplex.setOut(env.getNullStream());
-    cplex.setWarning(env.getNullStream());
-    while (true) {
-      cplex.solve();
-      // cplex.exportModel("NCBP.lp");
-      // solve the pricing problem
-      std::vector<IloNum> dualValues;
-      for (size_t i = 0; i < _processedItems.size(); ++i)
-        dualValues.push_back(
-            cplex.getDual(allCstrs.find(_processedItems[i]->idx)->second));
-      std::vector<int> selectedItems;
-      double value = dynamicPrg4KnapSack(dualValues, allWidths, _processedW,
-                                         selectedItems);
-      if (1.0 - value < -BLEU::tolerance)  // negative reduced cost
-      {
-        // add a column
-        std::set<int> newCol;
-        for (const auto& it : selectedItems)
-          newCol.insert(_processedItems[it]->idx);
-        IloNumColumn col(env);
-        for (const auto& it : newCol) {
-          auto ptr = allCstrs.find(it);
-          if (ptr != allCstrs.end()) col += ptr->second(1);
-        }
-        char varName[64];
-        sprintf_s(varName, 64, "Var %d", colIdx++);
-        IloNumVar var(col);
-        var.setName(varName);
-        var.setBounds(0, +IloInfinity);
-        NCBP.add(var);
-        realObj.setLinearCoef(var, 1.0);
-      } else {
-        double objValue = cplex.getObjValue();
-        env.end();
-        double lowerBound;
-        std::modf(objValue, &lowerBound);
-        if (objValue - lowerBound > BLEU::tolerance)
-          return lowerBound + 1 + _processedH;
-        else
-          return lowerBound + _processedH;
-      }
+  for (const auto& it : _processedItems) allWidths.push_back(it->width);
+  KnapsackPricer pricer;  // keeps its buffers over the iterations
+  std::vector<double> dualValues;
+  std::vector<int> selectedItems;
+  // the Farley bound of the last restricted master, valid at any iteration
+  double farleyBound = 0.0;
+  while (true) {
+    // the new columns are priced from the last basis
+    if (_context.timeUp() ||
+        lp.solve(_context.remainingSeconds()) != lpStatus::lpOptimal)
+      return int(std::ceil(farleyBound - BLEU::tolerance)) + _processedH;
+    // solve the pricing problem
+    dualValues.clear();
+    for (size_t i = 0; i < _processedItems.size(); ++i)
+      dualValues.push_back(lp.getDual(int(i)));
+    selectedItems.clear();
+    double value =
+        pricer.solve(dualValues, allWidths, _processedW, selectedItems);
+    // the duals scaled down by the best column value are feasible for the
+    // full master
+    farleyBound =
+        std::max(farleyBound, lp.getObjValue() / std::max(1.0, value));
+    if (1.0 - value < -BLEU::tolerance)  // negative reduced cost
+    {
+      // add a column
+      master.addColumn(selectedItems);
+    } else {
+      double objValue = lp.getObjValue();
+      double lowerBound;
+      std::modf(objValue, &lowerBound);
+      if (objValue - lowerBound > BLEU::tolerance)
+        return lowerBound + 1 + _processedH;
+      else
+        return lowerBound + _processedH;
     }
-    // add columns
-    // return the solution
-  } catch (IloException& e) {
-    std::cout << "NCBP error\n";
-    std::cout << e << std::endl;
-    return -1;
   }
 }
 
@@ -1122,20 +1384,17 @@ solve the root node of the parallel machine scheduling with contiguous
 constraints
 */
 const int StripPacking::BLEU::LowerBound5() const {
-  int maxHeight = _bestLowerBound - _processedH;
-  std::map<int, std::set<int>> mapPosWidth, mapPosHeight;
+  PhaseTimer timer(_context.statistics, lowerBound5Phase);
+  std::map<int, std::set<int>> mapPosWidth;
+  auto allPositionsWidth = computeAllFX(_processedW, _processedItems, true);
   for (size_t idx = 0; idx < _processedItems.size(); ++idx) {
-    auto possiblePositionsWidth = computeFX(
-        _processedW - _processedItems[idx]->width, idx, _processedItems, true);
-    auto possiblePositionsHeight = computeFX(
-        maxHeight - _processedItems[idx]->height, idx, _processedItems, false);
-    mapPosWidth.insert(std::pair<int, std::set<int>>(_processedItems[idx]->idx,
-                                                     possiblePositionsWidth));
-    mapPosHeight.insert(std::pair<int, std::set<int>>(_processedItems[idx]->idx,
-                                                      possiblePositionsHeight));
+    mapPosWidth.insert(std::pair<int, std::set<int>>(
+        _processedItems[idx]->idx, std::move(allPositionsWidth[idx])));
   }
-  auto lb =
-      solve(_processedItems, mapPosWidth, mapPosHeight, false) + _processedH;
+  if (_context.timeUp()) return 0;
+  auto lb = solve(_processedItems, mapPosWidth, false,
+                  _context.remainingSeconds(), _context.LPBackend) +
+            _processedH;
   if (std::floor(lb) - lb < BLEU::tolerance)
     lb = std::floor(lb);
   else
@@ -1152,13 +1411,11 @@ const bool StripPacking::BLEU::ifRotateInstance(
     const int t_binWidth) const {
   int sumH = 0;
   int sumW = 0;
+  auto numberPositionsWidth = countAllFX(t_binWidth, t_items, true);
+  auto numberPositionsHeight = countAllFX(t_binHeight, t_items, false);
   for (size_t idx = 0; idx < t_items.size(); ++idx) {
-    auto possiblePositionsWidth =
-        computeFX(t_binWidth - t_items[idx]->width, idx, t_items, true);
-    auto possiblePositionsHeight =
-        computeFX(t_binHeight - t_items[idx]->height, idx, t_items, false);
-    sumH += possiblePositionsHeight.size();
-    sumW += possiblePositionsWidth.size();
+    sumH += numberPositionsHeight[idx];
+    sumW += numberPositionsWidth[idx];
   }
   return (sumH < sumW);
 }
@@ -1176,37 +1433,172 @@ void StripPacking::BLEU::rotateInstance(std::vector<item*>& t_Items,
   t_binHeight = tmpWidth;
 }
 
-const double StripPacking::BLEU::DualFeasibleFunction1(
-    const int t_alpha, const int t_width) const {
-  double tmp = (t_alpha + 1.0) * ((double(t_width) / _processedW));
-  double intPart;
-  if (std::modf(tmp, &intPart) < BLEU::tolerance)  // if tmp is an integer
-    return t_width;
-  else
-    return (std::floor(tmp) * (_processedW / double(t_alpha)));
+/*
+f(w) = w if (alpha + 1) w / W is an integer, floor((alpha + 1) w / W) W / alpha
+otherwise, for alpha in [1, W]; the bound is ceil(sum f(w) h / W). Between two
+alphas where a floor changes, no (alpha + 1) w / W is an integer and the sum
+decreases with alpha, so only these alphas are evaluated. The sums are updated
+for the widths that change only, each width waiting in the bucket of its next
+change. The sum times alpha is an integer, the bound is exact. As f(w) <=
+(alpha + 1) w / alpha, no alpha with ceil((alpha + 1) area / (alpha W)) <=
+t_lowerBound can beat t_lowerBound, nor any larger one: the alphas stop there.
+Returns the larger of the bound and t_lowerBound.
+*/
+const int StripPacking::BLEU::DualFeasibleBound1(
+    const std::vector<int>& t_widths, const std::vector<long long>& t_heights,
+    const int t_lowerBound) const {
+  const int n = int(t_widths.size());
+  long long area = 0;
+  for (int i = 0; i < n; ++i) area += t_widths[i] * t_heights[i];
+  // the last alpha that may beat t_lowerBound
+  const long long W = _processedW;
+  long long maxAlpha = W;
+  const long long margin = W * t_lowerBound - area;
+  if (margin > 0) maxAlpha = std::min(maxAlpha, area / margin);
+  std::vector<long long> floor(n);  // floor((alpha + 1) w / W)
+  std::vector<char> integer(n);
+  long long floors = 0;    // sum floor h, not integers
+  long long integers = 0;  // sum w h, integers
+  // bucket[alpha]: the first width changing at alpha, then nextInBucket
+  std::vector<int> bucket(maxAlpha + 2, -1), nextInBucket(n, -1);
+  auto update = [&](const int t_i, const long long t_alpha) {
+    const long long p = (t_alpha + 1) * t_widths[t_i];
+    floor[t_i] = p / W;
+    integer[t_i] = floor[t_i] * W == p;
+    if (integer[t_i])
+      integers += t_widths[t_i] * t_heights[t_i];
+    else
+      floors += floor[t_i] * t_heights[t_i];
+    // an integer is not one at the next alpha, otherwise the floor changes at
+    // the smallest alpha with (alpha + 1) w >= (floor + 1) W
+    const long long next =
+        integer[t_i] ? t_alpha + 1
+                     : ((floor[t_i] + 1) * W + t_widths[t_i] - 1) /
+                               t_widths[t_i] -
+                           1;
+    if (next <= maxAlpha) {
+      nextInBucket[t_i] = bucket[next];
+      bucket[next] = t_i;
+    }
+  };
+  for (int i = 0; i < n; ++i) update(i, 1);
+  long long lowerBound = t_lowerBound;
+  for (long long alpha = 1; alpha <= maxAlpha; ++alpha) {
+    if (alpha > 1) {
+      if (bucket[alpha] < 0) continue;
+      for (int i = bucket[alpha]; i >= 0;) {
+        const int next = nextInBucket[i];
+        if (integer[i])
+          integers -= t_widths[i] * t_heights[i];
+        else
+          floors -= floor[i] * t_heights[i];
+        update(i, alpha);
+        i = next;
+      }
+    }
+    // ceil((integers + floors W / alpha) / W)
+    const long long numerator = alpha * integers + W * floors;
+    const long long denominator = alpha * W;
+    lowerBound =
+        std::max(lowerBound, (numerator + denominator - 1) / denominator);
+  }
+  return int(lowerBound);
 }
 
-const double StripPacking::BLEU::DualFeasibleFunction2(
-    const int t_alpha, const int t_width) const {
-  if (t_width > _processedW - t_alpha)
-    return _processedW;
-  else {
-    if (t_alpha <= t_width && t_width <= _processedW - t_alpha)
-      return t_width;
-    else
-      return 0;
+/*
+f(w) = W if w > W - alpha, w if alpha <= w <= W - alpha, 0 otherwise, for
+alpha in [1, W / 2]; the bound is ceil(sum f(w) h / W). f only changes at
+alpha = w + 1 and alpha = W - w + 1.
+*/
+const int StripPacking::BLEU::DualFeasibleBound2(
+    const std::vector<int>& t_widths,
+    const std::vector<long long>& t_heights) const {
+  const long long W = _processedW;
+  const long long maxAlpha = W / 2;
+  if (maxAlpha < 1) return 0;
+  std::vector<char> breakpoints(maxAlpha + 1, 0);
+  breakpoints[1] = 1;
+  for (const auto w : t_widths) {
+    if (w + 1 <= maxAlpha) breakpoints[w + 1] = 1;
+    if (W - w + 1 <= maxAlpha) breakpoints[W - w + 1] = 1;
   }
+  long long lowerBound = 0;
+  for (long long alpha = 1; alpha <= maxAlpha; ++alpha) {
+    if (!breakpoints[alpha]) continue;
+    long long sum = 0;
+    for (size_t i = 0; i < t_widths.size(); ++i) {
+      const long long w = t_widths[i];
+      const long long f = w > W - alpha ? W : (w >= alpha ? w : 0);
+      sum += f * t_heights[i];
+    }
+    lowerBound = std::max(lowerBound, (sum + W - 1) / W);
+  }
+  return int(lowerBound);
 }
 
-const double StripPacking::BLEU::DualFeasibleFunction3(
-    const int t_alpha, const int t_width) const {
-  if (t_width > (_processedW / 2.0))
-    return 2 * (std::floor(_processedW / double(t_alpha)) -
-                std::floor((_processedW - t_width) / double(t_alpha)));
-  if (std::abs(t_width - (_processedW / 2.0)) < StripPacking::BLEU::tolerance)
-    return std::floor(_processedW / double(t_alpha));
-  if (t_width < (_processedW / 2.0))
-    return 2 * std::floor(t_width / double(t_alpha));
+/*
+f(w) = 2 (floor(W / alpha) - floor((W - w) / alpha)) if w > W / 2,
+floor(W / alpha) if w = W / 2, 2 floor(w / alpha) otherwise, for alpha in
+[1, W / 2]; the bound is ceil(sum f(w) h / f(W)). Every floor(x / alpha) takes
+O(sqrt(x)) values, the sums are only updated, and the bound evaluated, where
+one of them changes.
+*/
+const int StripPacking::BLEU::DualFeasibleBound3(
+    const std::vector<int>& t_widths,
+    const std::vector<long long>& t_heights) const {
+  const long long W = _processedW;
+  const long long maxAlpha = W / 2;
+  if (maxAlpha < 1) return 0;
+  const int n = int(t_widths.size());
+  // S = floor(W / alpha) (2 large + half) - 2 sum large floor((W - w) / alpha)
+  //     + 2 sum small floor(w / alpha)
+  long long large = 0, half = 0;
+  std::vector<long long> x(n, 0), sign(n, 0), floor(n, 0);
+  for (int i = 0; i < n; ++i) {
+    const long long w = t_widths[i];
+    if (2 * w > W) {
+      large += t_heights[i];
+      x[i] = W - w;
+      sign[i] = -2;
+    } else if (2 * w == W) {
+      half += t_heights[i];
+    } else {
+      x[i] = w;
+      sign[i] = 2;
+    }
+  }
+  long long floors = 0;  // sum sign floor(x / alpha) h
+  std::vector<int> bucket(maxAlpha + 2, -1), nextInBucket(n, -1);
+  auto update = [&](const int t_i, const long long t_alpha) {
+    floor[t_i] = x[t_i] / t_alpha;
+    floors += sign[t_i] * floor[t_i] * t_heights[t_i];
+    if (floor[t_i] == 0) return;  // 0 from now on
+    const long long next = x[t_i] / floor[t_i] + 1;
+    if (next <= maxAlpha) {
+      nextInBucket[t_i] = bucket[next];
+      bucket[next] = t_i;
+    }
+  };
+  for (int i = 0; i < n; ++i)
+    if (sign[i] != 0) update(i, 1);
+  long long lowerBound = 0;
+  long long binFloor = 0;
+  for (long long alpha = 1; alpha <= maxAlpha; ++alpha) {
+    const bool binChanged = W / alpha != binFloor;
+    if (!binChanged && bucket[alpha] < 0) continue;
+    binFloor = W / alpha;
+    if (alpha > 1)
+      for (int i = bucket[alpha]; i >= 0;) {
+        const int next = nextInBucket[i];
+        floors -= sign[i] * floor[i] * t_heights[i];
+        update(i, alpha);
+        i = next;
+      }
+    const long long sum = binFloor * (2 * large + half) + floors;
+    const long long denominator = 2 * binFloor;
+    lowerBound = std::max(lowerBound, (sum + denominator - 1) / denominator);
+  }
+  return int(lowerBound);
 }
 
 void StripPacking::BLEU::dumpSolution(const char* file_name) const {
@@ -1281,16 +1673,3 @@ void StripPacking::BLEU::dumpSolution(
   }
   ofs.close();
 }
-// helper functions
-const std::set<int> StripPacking::BLEU::getItemsByCol(
-    const int t_Col, const std::vector<item*>& t_Items,
-    const std::vector<coordinate>& t_Cords) const {
-  std::set<int> result;
-  for (const auto& it : t_Items) {
-    if (t_Cords[it->idxHelper].x == -1) continue;
-    if (t_Cords[it->idxHelper].x <= t_Col &&
-        t_Col <= t_Cords[it->idxHelper].x + it->width - 1)
-      result.insert(it->idxHelper);
-  }
-  return result;
-}
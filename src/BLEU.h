@@ -5,11 +5,15 @@
  * If you have improvements, please contact me!
  */
 #pragma once
-#include <ilcplex/ilocplex.h>
-
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <stack>
 
+#include "solvercontext.h"
 #include "spp.h"
+#include "subsetsum.h"
+#include "transpositiontable.h"
 class itemPieceWidth;
 namespace StripPacking {
 
@@ -22,34 +26,32 @@ class BLEU {
  public:
   static double tolerance;
   static int bigNumber;
-  static int BBMaxExplNodesPerPack;  // maximal number of explored nodes for
-                                     // perfect packing (for the BB algorithm)
-  static int
-      BBMaxExplNodesNonPerPack;  // maximal number of explored nodes for
-                                 // non-perfect packing (for the BB algorithm)
-  static int interestingStatics;
-  static int ycheckExplNode;
-  static bool nodeLimitFlag;  // if y-check subroutine reaches node limit, it
-                              // becomes true;
-  static algorithmStatus algStatus;
-  /*
-  Explanation on the nodeLimitFlag and algStatus;
-  Before running an algorithm,
-  initialize with:
-          nodeLimitFlag = false; algStatus = exact
-  in-process:
-          as soon as ycheck exceeds node limit, nodeLimitFlag is flipped to
-  True. end: if solution status is infeasible and nodeLimitFlag = true, then the
-  algorithm is no longer exact, so algStatus = approximate
-  */
  public:
   BLEU(const std::vector<const item*>& t_items, const int t_W,
-       const int t_TrialHeight, const int t_timeLimit);
+       const int t_TrialHeight, const int t_timeLimit,
+       SolverContext& t_context);
   BLEU(const std::vector<const item*>& t_items, const int t_W,
-       const int t_timeLimit);
+       const int t_timeLimit, SolverContext& t_context);
   void preprocessing();
   void bounds();
-  const solutionStatus evaluate();
+  const solutionStatus evaluate();  // pending if a node limit or the time
+                                    // limit stopped the search
+  /*
+  Search the smallest feasible height: the upper bound comes from the
+  heuristics, then the heights between the bounds are evaluated (the lower
+  bound first, then by bisection), reusing the preprocessing and the bounds of
+  this object. Returns the best feasible height found. If a pending height had
+  to be skipped or the time limit stopped the search, the lower bound may stay
+  below the returned height and _context.algStatus is approximate.
+  */
+  const int optimize();
+  const int getLowerBound() const { return _bestLowerBound; }
+  const int getUpperBound() const { return _bestUpperBound; }
+  /*
+  The bound that gave the lower bound: the one that proved the trial height
+  infeasible or met the upper bound when the cascade of bounds() stopped early
+  */
+  const lowerBoundKind getDecidingBound() const { return _decidingBound; }
   const StripPacking::solutionStatus
   solvePCC();  // solve the parallel machine scheduling with contiguity
                // constraints
@@ -72,6 +74,7 @@ class BLEU {
       std::vector<item*>& t_items, const int t_binHeight,
       int& t_binWidth);  // only after the trial height is determined
   // 5.1 preprocess the bounds
+  const int heuristicUpperBound();
   const int LowerBound1() const;  // 5.1 lower bound 1
   const int LowerBound2() const;  // 5.2 lower bound 2
   const int LowerBound3() const;  // 5.3 lower bound 3
@@ -80,13 +83,15 @@ class BLEU {
   // cut items into pieces each of which has 1 unit height and the original
   // width
   void cutItemsAlongHeight();
-  // dual feasibility function
-  const double DualFeasibleFunction1(const int t_alpha,
-                                     const int t_width) const;
-  const double DualFeasibleFunction2(const int t_alpha,
-                                     const int t_width) const;
-  const double DualFeasibleFunction3(const int t_alpha,
-                                     const int t_width) const;
+  // bounds of the dual feasible functions of LowerBound2, over the distinct
+  // widths (increasing) and the total height of the items of each
+  const int DualFeasibleBound1(const std::vector<int>& t_widths,
+                               const std::vector<long long>& t_heights,
+                               const int t_lowerBound) const;
+  const int DualFeasibleBound2(const std::vector<int>& t_widths,
+                               const std::vector<long long>& t_heights) const;
+  const int DualFeasibleBound3(const std::vector<int>& t_widths,
+                               const std::vector<long long>& t_heights) const;
 
   // rotate instances
   void rotateInstance(std::vector<item*>& t_Items, int& t_binWidth,
@@ -98,13 +103,6 @@ class BLEU {
   The branch and bound algorithms----------------------------------------start
   */
 
-  class oneDimensionItem {
-   public:
-    oneDimensionItem(const int& t_weight, const int& t_value)
-        : weight(t_weight), value(t_value) {}
-    const int weight;
-    const int value;
-  };
   class BBNode {
    public:
     BBNode(const std::vector<const item*>& t_remainingItems, const int t_Width,
@@ -117,7 +115,10 @@ class BLEU {
            const item*
                t_placedItem);  // invoked when making a branch, the t_placedItem
                                // is the packed item in this time of branching
-    const int trialHeight;
+    // copy t_BBNode into this node, reusing the buffers of the vectors
+    void assign(const BBNode& t_BBNode);
+    void assign(const BBNode& t_BBNode, const item* t_placedItem);
+    int trialHeight;
     int leftMostIdx;
     std::vector<int>
         columnsOccupiedHeight;  // [10,5,3,2] means 10 units of height in the
@@ -131,19 +132,220 @@ class BLEU {
     std::vector<coordinate>
         itemPositions;  // store the final positions of all the items in
                         // processedItems (respect the order in processedItems)
+    std::vector<int> columnsDemand;  // y-check only: the height of the
+                                     // remaining items over each column
+  };
+  class BBNodePool;
+  class BBNodeRecycler {
+   public:
+    BBNodeRecycler() : pool(nullptr) {}
+    BBNodeRecycler(BBNodePool* t_pool) : pool(t_pool) {}
+    void operator()(BBNode* t_node) const;
+    BBNodePool* pool;
+  };
+  typedef std::unique_ptr<BBNode, BBNodeRecycler> BBNodePtr;
+  /*
+  The nodes of one search. They are stored in chunks and are never freed one
+  by one: a node that leaves the search goes back to the free list and the next
+  child is copied into it, so its vectors keep their capacity and branching
+  stops calling malloc once the deepest path has been built. Everything is
+  released with the pool, which must outlive the BBNodePtr it hands out.
+  */
+  class BBNodePool {
+   public:
+    explicit BBNodePool(const bool t_shared = false) : _shared(t_shared) {}
+    BBNodePtr makeNode(const std::vector<const item*>& t_remainingItems,
+                       const int t_Width, const int t_TrialHeight);
+    BBNodePtr makeNode(const std::vector<const item*>& t_remainingItems,
+                       const std::vector<coordinate>& t_Cords,
+                       const int t_Width, const int t_TrialHeight);
+    BBNodePtr makeNode(const BBNode& t_BBNode);
+    BBNodePtr makeNode(const BBNode& t_BBNode, const item* t_placedItem);
+    void recycle(BBNode* t_node);
+
+   private:
+    const bool _shared;  // lock every access, nodes move between threads
+    std::mutex _lock;
+    std::deque<BBNode> _nodes;  // owns all the nodes, addresses are stable
+    std::vector<BBNode*> _freeNodes;
+  };
+  /*
+  Undo record of one branching step of the depth-first search, enough to put
+  the mutable search state back to the node the step was made from
+  */
+  class BBTrailEntry {
+   public:
+    BBTrailEntry()
+        : placedItem(nullptr),
+          position(-1),
+          column(0),
+          leftMostIdx(0),
+          maxiItemIdx(-1),
+          itemPosition(-1, -1),
+          heightsBegin(0),
+          stateHash(0) {}
+    const item* placedItem;   // nullptr when the step packs nothing
+    int position;             // position of placedItem in remainingItems
+    int column;               // the column the step was made on
+    int leftMostIdx;          // leftMostIdx before the step
+    int maxiItemIdx;          // maxiItemIdxColumns[column] before the step
+    coordinate itemPosition;  // itemPositions of placedItem before the step
+    size_t heightsBegin;  // the heights of the columns from "column" on before
+                          // the step are saved in the trail from here
+    std::uint64_t stateHash;  // the hash of the state before the step
+  };
+  /*
+  A node on the path of the depth-first search: its branches are moves in the
+  shared move stack, each one a position in remainingItems (-1 packs nothing)
+  */
+  class BBTrailFrame {
+   public:
+    size_t movesBegin;
+    size_t nextMove;
+    int minHeight;        // the two smallest heights of the remaining items
+    int secondMinHeight;  // and the position of the smallest one, to get
+    int minPosition;      // the smallest height of the others in O(1)
+    bool applied;         // a child of this node is the current state
+    BBTrailEntry entry;   // how to get back from that child
+    std::uint64_t key;    // the key of the node in the transposition table
+    bool reachedLeaf;     // a y-check was run in the subtree
+    bool truncated;       // branches of the subtree were skipped by the
+                          // discrepancy limit
+    int discrepancies;    // branches other than the first one on the path
+  };
+  /*
+  Knapsack tables of dynamicCuts kept from one node to the next. Row j holds
+  the subset sums of the widths (heights) of the first j + 1 remaining items up
+  to the bin width (height) as a bitset, so one row answers all the left
+  corners. A child shares the prefix of remainingItems before the packed item
+  with its parent, so only the rows from there on are recomputed, and only
+  when the check gets to them.
+  */
+  class DynamicCutCache {
+   public:
+    DynamicCutCache()
+        : validRows(0),
+          widthCapacity(-1),
+          heightCapacity(-1),
+          widthWords(0),
+          heightWords(0) {}
+    // keep the rows shared by t_remainingItems and the items of the tables
+    void update(const std::vector<const item*>& t_remainingItems,
+                const int t_widthCapacity, const int t_heightCapacity);
+    // compute row t_row from row t_row - 1, which must be valid
+    void computeRow(const size_t t_row);
+    // the largest total width (height) of a subset of the first t_row + 1
+    // items not exceeding t_capacity
+    const int maxWidth(const size_t t_row, const int t_capacity) const {
+      return subsetSumMaxBit(widthRows.data() + t_row * widthWords,
+                             t_capacity);
+    }
+    const int maxHeight(const size_t t_row, const int t_capacity) const {
+      return subsetSumMaxBit(heightRows.data() + t_row * heightWords,
+                             t_capacity);
+    }
+    std::vector<const item*> items;  // the items the rows are computed for
+    size_t validRows;
+    int widthCapacity;
+    int heightCapacity;
+    size_t widthWords;
+    size_t heightWords;
+    std::vector<std::uint64_t> widthRows;
+    std::vector<std::uint64_t> heightRows;
+    // buffers of dynamicCuts, s, g and l of the paper, one entry per corner
+    std::vector<int> s0, s1, g0, g1, l0, l1, B;
+  };
+  /*
+  The local pool of a worker in the parallel branch and bound: the owner takes
+  nodes from the back (depth first), idle workers steal from the front (the
+  shallowest nodes, which carry the largest subtrees)
+  */
+  class BBWorkerQueue {
+   public:
+    std::mutex lock;
+    std::deque<BBNodePtr> nodes;
+  };
+  /*
+  An open node of the best-first search. The node with the largest slack, the
+  free area of the strip minus the area of the remaining items, is expanded
+  first; ties go to the deepest node, then to the first child of the latest
+  expansion, which is the DFS order when nothing is wasted.
+  */
+  class BBFrontierEntry {
+   public:
+    long long slack;
+    size_t depth;     // number of packed items
+    size_t sequence;  // insertion order
+    BBNodePtr node;
+    bool operator<(const BBFrontierEntry& t_other) const {
+      if (slack != t_other.slack) return slack < t_other.slack;
+      if (depth != t_other.depth) return depth < t_other.depth;
+      return sequence < t_other.sequence;
+    }
   };
 
  protected:
   const solutionStatus branchAndBound(const std::vector<const item*>& t_Items,
                                       const int t_binWidth,
-                                      const int t_binHeight);
+                                      const int t_binHeight,
+                                      const searchStrategy t_strategy);
+  /*
+  The sequential search of branchAndBound. A single BBNode is modified in
+  place when branching and restored from a trail when backtracking, so a step
+  costs the width of the packed item instead of a copy of the whole node.
+  The nodes whose subtree fails without reaching a leaf are remembered in a
+  transposition table, and the same state reached by another path is skipped.
+  With t_maxDiscrepancies >= 0, only the paths taking a branch other than the
+  first one at most that many times are explored, and t_truncated tells if
+  some branch was skipped. The explored nodes are added to
+  t_numberExploredNodes.
+  */
+  const solutionStatus depthFirstSearch(const std::vector<const item*>& t_Items,
+                                        const int t_binWidth,
+                                        const int t_binHeight,
+                                        const int t_maxExpNodes,
+                                        const int t_maxDiscrepancies,
+                                        int& t_numberExploredNodes,
+                                        bool& t_truncated);
+  /*
+  Depth-first waves allowing 0, 1, 2... discrepancies, until a leaf passes
+  the y-check or a wave is not truncated. Nodes explored again by a later wave
+  count again against t_maxExpNodes.
+  */
+  const solutionStatus limitedDiscrepancySearch(
+      const std::vector<const item*>& t_Items, const int t_binWidth,
+      const int t_binHeight, const int t_maxExpNodes);
+  const solutionStatus bestFirstSearch(const std::vector<const item*>& t_Items,
+                                       const int t_binWidth,
+                                       const int t_binHeight,
+                                       const int t_maxExpNodes);
+  const long long slackArea(const BBNode& t_node) const;
+  void listBranches(const BBNode& t_state, BBTrailFrame& t_frame,
+                    std::vector<int>& t_moves) const;
+  void applyBranch(BBNode& t_state, BBTrailFrame& t_frame, const int t_move,
+                   std::vector<int>& t_savedHeights,
+                   std::uint64_t& t_stateHash) const;
+  void undoBranch(BBNode& t_state, const BBTrailEntry& t_entry,
+                  std::vector<int>& t_savedHeights,
+                  std::uint64_t& t_stateHash) const;
+  const solutionStatus branchAndBoundParallel(
+      const std::vector<const item*>& t_Items, const int t_binWidth,
+      const int t_binHeight, const int t_maxExpNodes);
   const solutionStatus branchAndBoundYRelax(
       const std::vector<const item*>& t_Items, const int t_binWidth,
       const int t_binHeight);
-  void makeBranch(const std::unique_ptr<BBNode>& t_currentNode,
-                  std::stack<std::unique_ptr<BBNode>>& t_dfstree) const;
-  const bool bounding(const std::unique_ptr<BBNode>& t_currentNode) const;
-  const bool dynamicCuts(const std::unique_ptr<BBNode>& t_currentNode) const;
+  /*
+  Called once per explored node by every search with its node count: every
+  SolverContext::checkInterval nodes the clock is read and the progress is
+  reported. Returns true if the search has to stop (deadline or cancel).
+  */
+  const bool checkpoint(const long long t_count, const int t_depth) const;
+  void makeBranch(const BBNodePtr& t_currentNode,
+                  std::stack<BBNodePtr>& t_dfstree, BBNodePool& t_pool) const;
+  const bool bounding(const BBNode& t_currentNode,
+                      DynamicCutCache& t_cache) const;
+  const bool dynamicCuts(const BBNode& t_currentNode,
+                         DynamicCutCache& t_cache) const;
 
   /*
   The branch and bound algorithms----------------------------------------end
@@ -154,7 +356,7 @@ class BLEU {
   */
   bool yCheckAlgorithm(const int t_processedW, const int t_TrialHeight,
                        const std::vector<coordinate>& itemPositions,
-                       const std::vector<const item*> t_processedItems) const;
+                       const std::vector<const item*>& t_processedItems) const;
 
   /*
   The enumerate tree described right before section 4
@@ -163,9 +365,10 @@ class BLEU {
       const std::vector<const item*>& t_InterestItems,
       const std::vector<coordinate>& t_Cords, const int t_Height,
       const int t_Width) const;
-  bool yCheckBounding(const std::unique_ptr<BBNode>& t_currentNode) const;
-  void yCheckMakeBranch(const std::unique_ptr<BBNode>& t_currentNode,
-                        std::stack<std::unique_ptr<BBNode>>& t_yEntree) const;
+  bool yCheckBounding(const BBNodePtr& t_currentNode) const;
+  void yCheckMakeBranch(const BBNodePtr& t_currentNode,
+                        std::stack<BBNodePtr>& t_yEntree,
+                        BBNodePool& t_pool) const;
   /*
   Given column heights, return a Niche which is featured as the start column and
   the end column the return value is a two dimensional array, one element of the
@@ -203,8 +406,6 @@ class BLEU {
   // output: bool, change the items in the left of i
   */
   bool mergeItems4yCheck(std::vector<item*>& t_allItems, item* t_i,
-                         std::map<int, std::list<item*>>& t_leftItems,
-                         std::map<int, std::list<item*>>& t_rightItems,
                          std::list<item*>& t_Items,
                          std::vector<coordinate>& t_Cords, const bool t_left,
                          const int t_binWidth) const;
@@ -232,10 +433,6 @@ class BLEU {
                std::vector<coordinate>& t_Cords, const int t_startColumn,
                const int t_maxWidth, std::list<item*>& t_Items,
                const bool t_left) const;
-  const std::vector<std::map<int, std::list<item*>>> getLeftsAndRights(
-      const std::vector<item*>& t_allItems,
-      const std::vector<coordinate>& t_Cords,
-      const std::set<int>& t_coveredItems) const;
   void mergeItems(item* t_i, std::list<item*>& t_Items,
                   std::map<int, std::list<item*>>& t_allItems,
                   std::vector<coordinate>& t_Cords) const;
@@ -259,13 +456,6 @@ class BLEU {
       const std::vector<const item*>& t_allItems,
       const std::vector<coordinate>& t_Cords) const;
 
-  //---- helper functions
-  /* t_Cords respects the idxHelper , return the set of idxHelpers of items
-   * that occupy the column t_Col*/
-  const std::set<int> getItemsByCol(
-      const int t_Col, const std::vector<item*>& t_Items,
-      const std::vector<coordinate>& t_Cords) const;
-
  private:
   std::vector<const item*> _allItems;
   std::vector<const itemPieceWidth*> _allItemPiecesWidths;
@@ -276,11 +466,16 @@ class BLEU {
   int _processedH;
   int _processedW;
   int _bestLowerBound;
+  int _bestUpperBound;  // the best feasible height known, set by bounds()
+                        // and optimize(); -1 if none
+  lowerBoundKind _decidingBound;  // the first bound that reached
+                                  // _bestLowerBound
   int _trialHeight;  // the current height being tried
   std::vector<coordinate> _finalSolution;
   const bool _evaluatedMode;  // if it is true, then the algorithm starts from a
                               // given height, the mission is to determine if
                               // the height is feasible
   const int _timeLimit;
+  SolverContext& _context;  // limits, counters and flags of this solve
 };
 }  // namespace StripPacking
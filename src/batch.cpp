@@ -0,0 +1,375 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#include "batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "BLEU.h"
+#include "datareader.h"
+#include "solvercontext.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+const char* statusName(const StripPacking::solutionStatus t_status) {
+  switch (t_status) {
+    case StripPacking::solutionStatus::feasible:
+      return "feasible";
+    case StripPacking::solutionStatus::infeasible:
+      return "infeasible";
+    case StripPacking::solutionStatus::pending:
+      return "pending";
+    default:
+      return "error";
+  }
+}
+
+const char* modeName(const StripPacking::batchMode t_mode) {
+  return t_mode == StripPacking::batchMode::optimizeHeight ? "optimize"
+                                                           : "evaluate";
+}
+
+const char* phaseNames[StripPacking::numberSolverPhase] = {
+    "preprocessing", "lowerBound1",    "lowerBound2", "lowerBound3",
+    "lowerBound4",   "lowerBound5",    "branchAndBound", "yCheck"};
+
+const char* boundNames[StripPacking::numberLowerBoundKind] = {"LB1", "LB2",
+                                                             "LB3", "LB4",
+                                                             "LB5"};
+
+const char* fathomNames[StripPacking::numberFathomCriterion] = {
+    "identicalItems", "area",           "dynamicCut",  "transposition",
+    "columnHeight",   "identicalItems", "swappedItems"};
+
+const std::string escapeJson(const std::string& t_str) {
+  std::string result;
+  for (const auto it : t_str) {
+    if (it == '"' || it == '\\') result.push_back('\\');
+    result.push_back(it);
+  }
+  return result;
+}
+
+void releaseItems(std::vector<const StripPacking::item*>& t_items) {
+  for (auto& it : t_items) delete it;
+  t_items.clear();
+}
+
+/*
+Solve t_job in a child process and take its peak memory from wait4; the child
+sends the rest of the result back through a pipe. False if no child could be
+started (always on Windows), t_result is then left untouched.
+*/
+bool solveJobInChild(const StripPacking::BatchJob& t_job,
+                     const int t_BBNumThreads,
+                     const StripPacking::searchStrategy t_strategy,
+                     const StripPacking::lpBackend t_LPBackend,
+                     std::mutex& t_outLock,
+                     StripPacking::BatchResult& t_result) {
+#ifdef _WIN32
+  return false;
+#else
+  int fds[2];
+  if (pipe(fds) != 0) return false;
+  auto start = std::chrono::steady_clock::now();
+  pid_t child;
+  {
+    // the other threads only write under t_outLock, so none holds a lock of
+    // the streams at the fork; the buffered output must not be copied either
+    std::lock_guard<std::mutex> guard(t_outLock);
+    std::cout.flush();
+    std::fflush(stdout);
+    child = fork();
+  }
+  if (child < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  if (child == 0) {
+    close(fds[0]);
+    std::ostringstream ss;
+    int exitCode = 0;
+    try {
+      auto result = StripPacking::solveJob(t_job, t_BBNumThreads, t_strategy,
+                                           t_LPBackend);
+      // status, lowerBoundBy and statistics hold no line break
+      ss << result.status << "\n"
+         << result.lowerBoundBy << "\n"
+         << result.statistics << "\n"
+         << result.exact << " " << result.timedOut << " " << result.lowerBound
+         << " " << result.upperBound << " " << result.exploredNodes << " "
+         << std::setprecision(17) << result.wallSeconds;
+    } catch (const std::exception& e) {
+      ss << e.what();
+      exitCode = 1;
+    }
+    const std::string message = ss.str();
+    size_t sent = 0;
+    while (sent < message.size()) {
+      ssize_t n = write(fds[1], message.data() + sent, message.size() - sent);
+      if (n <= 0) break;
+      sent += n;
+    }
+    _exit(exitCode);
+  }
+  close(fds[1]);
+  std::string message;
+  char buffer[4096];
+  ssize_t n;
+  while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+    message.append(buffer, n);
+  close(fds[0]);
+  t_result.file = t_job.file;
+  t_result.mode = t_job.mode;
+  t_result.trialHeight = t_job.trialHeight;
+  int status = 0;
+  struct rusage usage;
+  const bool waited = wait4(child, &status, 0, &usage) == child;
+  if (waited) {
+#ifdef __APPLE__
+    t_result.peakMemoryKB = usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+    t_result.peakMemoryKB = usage.ru_maxrss;  // kilobytes on Linux
+#endif
+  }
+  if (waited && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+    std::istringstream ss(message);
+    std::getline(ss, t_result.status);
+    std::getline(ss, t_result.lowerBoundBy);
+    std::getline(ss, t_result.statistics);
+    ss >> t_result.exact >> t_result.timedOut >> t_result.lowerBound >>
+        t_result.upperBound >> t_result.exploredNodes >> t_result.wallSeconds;
+  } else {
+    t_result.wallSeconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+    std::lock_guard<std::mutex> guard(t_outLock);
+    std::cout << "failed to solve " << t_job.file << ": "
+              << (message.empty() ? "the solving process ended abnormally"
+                                  : message)
+              << std::endl;
+  }
+  return true;
+#endif
+}
+}  // namespace
+
+std::vector<StripPacking::BatchJob> StripPacking::readJobFile(
+    const std::string& t_jobFile, const int t_defaultTimeLimit) {
+  std::vector<BatchJob> jobs;
+  std::ifstream ff(t_jobFile);
+  if (!ff.is_open()) {
+    std::cout << "cann't open the job file " << t_jobFile << std::endl;
+    return jobs;
+  }
+  std::string line;
+  while (std::getline(ff, line)) {
+    std::istringstream ss(line);
+    std::string file, height;
+    if (!(ss >> file) || file[0] == '#') continue;
+    int timeLimit = t_defaultTimeLimit;
+    ss >> height >> timeLimit;
+    if (height.empty() || height == "optimize")
+      jobs.push_back(BatchJob(file, batchMode::optimizeHeight, -1, timeLimit));
+    else
+      jobs.push_back(BatchJob(file, batchMode::evaluateHeight,
+                              std::stoi(height), timeLimit));
+  }
+  return jobs;
+}
+
+std::vector<StripPacking::BatchJob> StripPacking::listJobs(
+    const std::string& t_path, const batchMode t_mode,
+    const int t_trialHeight, const int t_timeLimit) {
+  namespace fs = std::filesystem;
+  std::vector<BatchJob> jobs;
+  if (!fs::is_directory(t_path)) {
+    jobs.push_back(BatchJob(t_path, t_mode, t_trialHeight, t_timeLimit));
+    return jobs;
+  }
+  std::vector<std::string> files;
+  for (const auto& entry : fs::directory_iterator(t_path))
+    if (fs::is_regular_file(entry.path()))
+      files.push_back(entry.path().string());
+  std::sort(files.begin(), files.end());
+  for (const auto& it : files)
+    jobs.push_back(BatchJob(it, t_mode, t_trialHeight, t_timeLimit));
+  return jobs;
+}
+
+StripPacking::BatchResult StripPacking::solveJob(
+    const BatchJob& t_job, const int t_BBNumThreads,
+    const searchStrategy t_strategy, const lpBackend t_LPBackend,
+    const std::shared_ptr<NCBPMaster>& t_NCBP) {
+  BatchResult result;
+  result.file = t_job.file;
+  result.mode = t_job.mode;
+  result.trialHeight = t_job.trialHeight;
+  auto start = std::chrono::steady_clock::now();
+  auto elapsed = [&start]() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+  };
+  std::vector<const item*> allItems;
+  int W = readData(t_job.file, allItems);
+  if (allItems.empty() || W <= 0) {
+    result.wallSeconds = elapsed();
+    return result;
+  }
+  SolverContext context;
+  context.BBNumThreads = t_BBNumThreads;
+  context.BBStrategy = t_strategy;
+  context.LPBackend = t_LPBackend;
+  if (t_NCBP) context.NCBP = t_NCBP;
+  if (t_job.mode == batchMode::evaluateHeight) {
+    BLEU alg(allItems, W, t_job.trialHeight, t_job.timeLimit, context);
+    auto status = alg.evaluate();
+    result.status = statusName(status);
+    result.lowerBound = alg.getLowerBound();
+    result.lowerBoundBy = boundNames[alg.getDecidingBound()];
+    if (status == solutionStatus::feasible) {
+      result.upperBound = t_job.trialHeight;
+    } else if (status == solutionStatus::infeasible &&
+               context.algStatus == algorithmStatus::exact) {
+      result.lowerBound = std::max(result.lowerBound, t_job.trialHeight + 1);
+    }
+    result.exact = context.algStatus == algorithmStatus::exact;
+  } else {
+    BLEU alg(allItems, W, t_job.timeLimit, context);
+    alg.optimize();
+    result.lowerBound = alg.getLowerBound();
+    result.lowerBoundBy = boundNames[alg.getDecidingBound()];
+    result.upperBound = alg.getUpperBound();
+    result.status = result.lowerBound == result.upperBound
+                        ? "optimal"
+                        : statusName(solutionStatus::feasible);
+    result.exact = context.algStatus == algorithmStatus::exact;
+  }
+  releaseItems(allItems);
+  result.timedOut = context.stopFlag;
+  result.exploredNodes = context.exploredNodes;
+  result.statistics = toJson(context);
+  result.wallSeconds = elapsed();
+  return result;
+}
+
+std::vector<StripPacking::BatchResult> StripPacking::runBatch(
+    const std::vector<BatchJob>& t_jobs, const int t_numThreads,
+    const int t_BBNumThreads, const searchStrategy t_strategy,
+    const lpBackend t_LPBackend, const bool t_isolate, std::ostream& t_out) {
+  std::vector<BatchResult> results(t_jobs.size());
+  std::atomic<size_t> nextJob(0);
+  std::mutex outLock;
+  auto worker = [&]() {
+    // in this process, the jobs of a thread share their columns, a job often
+    // repeats the instance of the previous one with another height
+    std::shared_ptr<NCBPMaster> master;
+    if (!t_isolate) master = std::make_shared<NCBPMaster>();
+    while (true) {
+      size_t job = nextJob.fetch_add(1);
+      if (job >= t_jobs.size()) return;
+      try {
+        if (!t_isolate ||
+            !solveJobInChild(t_jobs[job], t_BBNumThreads, t_strategy,
+                             t_LPBackend, outLock, results[job]))
+          results[job] = solveJob(t_jobs[job], t_BBNumThreads, t_strategy,
+                                  t_LPBackend, master);
+      } catch (const std::exception& e) {
+        std::lock_guard<std::mutex> guard(outLock);
+        std::cout << "failed to solve " << t_jobs[job].file << ": " << e.what()
+                  << std::endl;
+        results[job].file = t_jobs[job].file;
+        results[job].mode = t_jobs[job].mode;
+        results[job].trialHeight = t_jobs[job].trialHeight;
+      }
+      std::lock_guard<std::mutex> guard(outLock);
+      t_out << toJson(results[job]) << std::endl;
+    }
+  };
+  std::vector<std::thread> threads;
+  int numThreads = std::max(1, std::min(t_numThreads, int(t_jobs.size())));
+  for (int i = 0; i < numThreads; ++i) threads.emplace_back(worker);
+  for (auto& it : threads) it.join();
+  return results;
+}
+
+const std::string StripPacking::toJson(const BatchResult& t_result) {
+  std::ostringstream ss;
+  auto bound = [&ss](const int t_value) {
+    if (t_value < 0)
+      ss << "null";
+    else
+      ss << t_value;
+  };
+  ss << "{\"instance\":\"" << escapeJson(t_result.file) << "\",\"mode\":\""
+     << modeName(t_result.mode) << "\",\"trialHeight\":";
+  bound(t_result.mode == batchMode::evaluateHeight ? t_result.trialHeight
+                                                   : -1);
+  ss << ",\"status\":\"" << t_result.status
+     << "\",\"exact\":" << (t_result.exact ? "true" : "false")
+     << ",\"timedOut\":" << (t_result.timedOut ? "true" : "false")
+     << ",\"lowerBound\":";
+  bound(t_result.lowerBound);
+  ss << ",\"upperBound\":";
+  bound(t_result.upperBound);
+  if (!t_result.lowerBoundBy.empty())
+    ss << ",\"lowerBoundBy\":\"" << t_result.lowerBoundBy << "\"";
+  ss << ",\"nodes\":" << t_result.exploredNodes
+     << ",\"wallSeconds\":" << t_result.wallSeconds << ",\"peakMemoryKB\":";
+  if (t_result.peakMemoryKB < 0)
+    ss << "null";
+  else
+    ss << t_result.peakMemoryKB;
+  if (!t_result.statistics.empty())
+    ss << ",\"statistics\":" << t_result.statistics;
+  ss << "}";
+  return ss.str();
+}
+
+const std::string StripPacking::toJson(const SolverContext& t_context) {
+  const SolverStatistics& stats = t_context.statistics;
+  std::ostringstream ss;
+  auto fathoms = [&](const int t_begin, const int t_end) {
+    ss << "{";
+    for (int i = t_begin; i < t_end; ++i)
+      ss << (i > t_begin ? "," : "") << "\"" << fathomNames[i]
+         << "\":" << stats.fathoms[i];
+    ss << "}";
+  };
+  ss << "{\"seconds\":{";
+  for (int i = 0; i < numberSolverPhase; ++i)
+    ss << (i > 0 ? "," : "") << "\"" << phaseNames[i]
+       << "\":" << stats.phaseSeconds(solverPhase(i));
+  ss << "},\"branchAndBound\":{\"calls\":"
+     << stats.phaseCalls[branchAndBoundPhase]
+     << ",\"nodes\":" << t_context.exploredNodes << ",\"fathoms\":";
+  fathoms(BBIdenticalItems, yCheckColumnHeight);
+  ss << ",\"maxStackSize\":" << stats.BBMaxStackSize
+     << "},\"yCheck\":{\"calls\":" << stats.yCheckCalls
+     << ",\"feasible\":" << stats.yCheckFeasible
+     << ",\"cacheHits\":" << t_context.yCheckCache.getHits()
+     << ",\"nodes\":" << stats.yCheckNodes << ",\"fathoms\":";
+  fathoms(yCheckColumnHeight, numberFathomCriterion);
+  ss << ",\"maxStackSize\":" << stats.yCheckMaxStackSize << "}}";
+  return ss.str();
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#pragma once
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "lpsolver.h"
+#include "ncbpmaster.h"
+#include "spp.h"
+namespace StripPacking {
+class SolverContext;
+
+/*
+Batch solving: a list of instances is spread over a pool of threads, every
+instance is solved with its own SolverContext, and one JSON record per instance
+is written as soon as it is done.
+*/
+enum batchMode {
+  evaluateHeight,  // answer feasible/infeasible for the given trial height
+  optimizeHeight,  // search the smallest feasible height
+  numberBatchMode
+};
+
+class BatchJob {
+ public:
+  BatchJob(const std::string& t_file, const batchMode t_mode,
+           const int t_trialHeight, const int t_timeLimit)
+      : file(t_file),
+        mode(t_mode),
+        trialHeight(t_trialHeight),
+        timeLimit(t_timeLimit) {}
+  std::string file;
+  batchMode mode;
+  int trialHeight;  // only read in evaluateHeight mode
+  int timeLimit;    // seconds
+};
+
+class BatchResult {
+ public:
+  BatchResult()
+      : mode(batchMode::evaluateHeight),
+        trialHeight(-1),
+        status("error"),
+        exact(true),
+        timedOut(false),
+        lowerBound(-1),
+        upperBound(-1),
+        exploredNodes(0),
+        wallSeconds(0.0),
+        peakMemoryKB(-1) {}
+  std::string file;
+  batchMode mode;
+  int trialHeight;
+  std::string status;  // feasible, infeasible, pending, optimal or error
+  bool exact;          // false if a y-check node limit made the answer
+                       // approximate
+  bool timedOut;       // the time limit stopped the solve, the bounds and the
+                       // counters are the ones reached by then
+  int lowerBound;      // -1 when unknown
+  int upperBound;      // -1 when unknown
+  std::string lowerBoundBy;  // the bound that gave lowerBound before the
+                             // search (BLEU::getDecidingBound)
+  long long exploredNodes;
+  double wallSeconds;
+  // the peak resident memory of the child process that solved the instance,
+  // it includes the few MB of the driver inherited at the fork; -1 (null) when
+  // the instance was solved in the driver process, where it cannot be told
+  // apart from the other instances
+  long peakMemoryKB;
+  std::string statistics;  // toJson of the context of the solve
+};
+
+/*
+The jobs of a job file, one per line: "<file> <height|optimize> [timeLimit]".
+Empty lines and lines starting with # are skipped.
+*/
+std::vector<BatchJob> readJobFile(const std::string& t_jobFile,
+                                  const int t_defaultTimeLimit);
+/*
+One job per instance file of t_path (a directory or a single file)
+*/
+std::vector<BatchJob> listJobs(const std::string& t_path,
+                               const batchMode t_mode,
+                               const int t_trialHeight,
+                               const int t_timeLimit);
+/*
+t_NCBP: the LowerBound4 master of the previous jobs of the thread, whose
+columns are reused; a new one if null
+*/
+BatchResult solveJob(const BatchJob& t_job, const int t_BBNumThreads,
+                     const searchStrategy t_strategy,
+                     const lpBackend t_LPBackend,
+                     const std::shared_ptr<NCBPMaster>& t_NCBP = nullptr);
+/*
+Solve all the jobs with t_numThreads instances at a time. A record is written
+to t_out as each instance finishes; the returned results follow the job order.
+With t_isolate, every instance is solved in a child process so that its peak
+memory is measured; otherwise (and on Windows) the instances are solved in
+this process and the jobs of a thread share their LowerBound4 columns.
+*/
+std::vector<BatchResult> runBatch(const std::vector<BatchJob>& t_jobs,
+                                  const int t_numThreads,
+                                  const int t_BBNumThreads,
+                                  const searchStrategy t_strategy,
+                                  const lpBackend t_LPBackend,
+                                  const bool t_isolate, std::ostream& t_out);
+const std::string toJson(const BatchResult& t_result);
+/*
+The statistics of a solve: seconds per phase, then nodes, fathoms per
+criterion and the largest stack of the branch and bound and of the y-check
+*/
+const std::string toJson(const SolverContext& t_context);
+}  // namespace StripPacking
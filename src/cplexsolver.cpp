@@ -0,0 +1,71 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#include "cplexsolver.h"
+#ifdef SPP_USE_CPLEX
+
+StripPacking::CplexSolver::CplexSolver()
+    : _model(_env), _objective(IloMinimize(_env)), _objValue(0.0) {
+  _model.add(_objective);
+  _cplex = IloCplex(_model);
+  _cplex.setOut(_env.getNullStream());
+  _cplex.setWarning(_env.getNullStream());
+}
+
+StripPacking::CplexSolver::~CplexSolver() { _env.end(); }
+
+int StripPacking::CplexSolver::addRow(const rowSense t_sense,
+                                      const double t_rhs) {
+  const double lower = t_sense == rowSense::lessEqual ? -IloInfinity : t_rhs;
+  const double upper = t_sense == rowSense::greaterEqual ? IloInfinity : t_rhs;
+  _ranges.push_back(IloRange(_env, lower, upper));
+  _model.add(_ranges.back());
+  return int(_ranges.size()) - 1;
+}
+
+int StripPacking::CplexSolver::addColumn(const double t_cost,
+                                         const double t_upper,
+                                         const std::vector<int>& t_rows,
+                                         const std::vector<double>& t_values,
+                                         const bool t_integer) {
+  IloNumColumn col = _objective(t_cost);
+  for (size_t k = 0; k < t_rows.size(); ++k)
+    col += _ranges[t_rows[k]](t_values[k]);
+  const double upper = t_upper >= lpInfinity ? IloInfinity : t_upper;
+  _columns.push_back(
+      IloNumVar(col, 0, upper, t_integer ? ILOINT : ILOFLOAT));
+  col.end();
+  return int(_columns.size()) - 1;
+}
+
+StripPacking::lpStatus StripPacking::CplexSolver::solve(
+    const double t_timeLimit) {
+  try {
+    if (t_timeLimit >= 0)
+      _cplex.setParam(IloCplex::Param::TimeLimit, t_timeLimit);
+    if (!_cplex.solve()) {
+      const auto status = _cplex.getStatus();
+      if (status == IloAlgorithm::Infeasible) return lpInfeasible;
+      if (status == IloAlgorithm::Unbounded) return lpUnbounded;
+      return lpStopped;
+    }
+    if (_cplex.getStatus() != IloAlgorithm::Optimal) return lpStopped;
+    _objValue = _cplex.getObjValue();
+    _values.clear();
+    for (const auto& it : _columns) _values.push_back(_cplex.getValue(it));
+    _duals.clear();
+    if (!_cplex.isMIP())  // no duals for a MIP
+      for (const auto& it : _ranges) _duals.push_back(_cplex.getDual(it));
+    else
+      _duals.assign(_ranges.size(), 0.0);
+    return lpOptimal;
+  } catch (IloException& e) {
+    std::cout << "CPLEX error\n";
+    std::cout << e << std::endl;
+    return lpError;
+  }
+}
+#endif
@@ -0,0 +1,47 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#pragma once
+#ifdef SPP_USE_CPLEX
+#include <ilcplex/ilocplex.h>
+
+#include <vector>
+
+#include "lpsolver.h"
+namespace StripPacking {
+
+/*
+The LPSolver interface over Concert; only compiled with SPP_USE_CPLEX
+*/
+class CplexSolver : public LPSolver {
+ public:
+  CplexSolver();
+  ~CplexSolver();
+  int addRow(const rowSense t_sense, const double t_rhs) override;
+  int addColumn(const double t_cost, const double t_upper,
+                const std::vector<int>& t_rows,
+                const std::vector<double>& t_values,
+                const bool t_integer) override;
+  lpStatus solve(const double t_timeLimit) override;
+  double getObjValue() const override { return _objValue; }
+  double getDual(const int t_row) const override { return _duals[t_row]; }
+  double getValue(const int t_column) const override {
+    return _values[t_column];
+  }
+
+ private:
+  IloEnv _env;
+  IloModel _model;
+  IloObjective _objective;
+  IloCplex _cplex;
+  std::vector<IloRange> _ranges;
+  std::vector<IloNumVar> _columns;
+  double _objValue;
+  std::vector<double> _duals;
+  std::vector<double> _values;
+};
+}  // namespace StripPacking
+#endif
@@ -12,7 +12,6 @@
 #include <iostream>
 
 #include "skyline.h"
-std::vector<StripPacking::coordinate> StripPacking::Heuristic::solutions;
 
 const int StripPacking::Heuristic::parseSol(
     const StripPacking::Skyline* t_skyline) {
@@ -31,9 +30,9 @@ const int StripPacking::Heuristic::parseSol(
 const int StripPacking::Heuristic::leftBottomHeuristic(
     const std::vector<const StripPacking::item*>& t_allItems,
     const int t_binWidth) {
-  Heuristic::solutions.clear();
+  _context.heuristicSolutions.clear();
   for (int i = 0; i < t_allItems.size(); ++i)
-    Heuristic::solutions.push_back(coordinate(0, 0));
+    _context.heuristicSolutions.push_back(coordinate(0, 0));
   // initialize the skyline
   Skyline* stripBottom = new Skyline(t_binWidth);
   Skyline* leftSide = new Skyline(false);
@@ -54,7 +53,7 @@ const int StripPacking::Heuristic::leftBottomHeuristic(
         break;
     }
 
-    addItemOverSkyline(selectedSkyline, it);
+    addItemOverSkyline(selectedSkyline, it, _context);
   }
   int result = this->parseSol(leftSide);
   delete leftSide;
@@ -67,8 +66,8 @@ void StripPacking::Heuristic::dumpSolution(
   std::ofstream sol("Solution.output");
   for (const auto& it : t_allItems) {
     rec << it->idx << "," << it->width << "," << it->height << "\n";
-    sol << it->idx << "," << Heuristic::solutions[it->idx].x << ","
-        << Heuristic::solutions[it->idx].y << "\n";
+    sol << it->idx << "," << _context.heuristicSolutions[it->idx].x << ","
+        << _context.heuristicSolutions[it->idx].y << "\n";
   }
   rec.close();
   sol.close();
@@ -112,9 +111,9 @@ const StripPacking::item* StripPacking::Heuristic::findBestItem(
 const int StripPacking::Heuristic::bestFitHeuristic(
     std::vector<const StripPacking::item*>& t_allItems, const int t_binWidth) {
   // sort all items by the non-increasing order of width
-  Heuristic::solutions.clear();
+  _context.heuristicSolutions.clear();
   for (int i = 0; i < t_allItems.size(); ++i)
-    Heuristic::solutions.push_back(coordinate(0, 0));
+    _context.heuristicSolutions.push_back(coordinate(0, 0));
   // initialize the skyline
   Skyline* stripBottom = new Skyline(t_binWidth);
   Skyline* leftSide = new Skyline(false);
@@ -144,13 +143,13 @@ const int StripPacking::Heuristic::bestFitHeuristic(
     // if none can fit, scenario = 2
     switch (scenario) {
       case 0: {
-        addItemOverSkyline(selectedSkyline, bestFitItem);
+        addItemOverSkyline(selectedSkyline, bestFitItem, _context);
         break;
       }
       case 1: {
-        addItemOverSkyline(selectedSkyline,
-                           bestFitItem);  // niche placement policy: place the
-                                          // item at the leftside of the niche
+        addItemOverSkyline(selectedSkyline, bestFitItem,
+                           _context);  // niche placement policy: place the
+                                       // item at the leftside of the niche
         break;
       }
       case 2: {
@@ -171,7 +170,6 @@ const int StripPacking::Heuristic::iteratedGreedy(
     std::vector<const StripPacking::item*>& t_allItems, const int t_binWidth) {
   bool improved = true;
   int primalBound = this->leftBottomHeuristic(t_allItems, t_binWidth);
-  std::cout << "\nthe initial best primal bound is " << primalBound << "\n";
   while (improved) {
     improved = false;
     // explore the insertion neighborhood
@@ -204,9 +202,9 @@ the niche 3) keep the above two steps until no item is left.
 const bool StripPacking::Heuristic::generalBestFitHeurisitic(
     std::vector<const StripPacking::item*>& t_allItems,
     const std::vector<const StripPacking::item*>& t_Bins) {
-  Heuristic::solutions.clear();
+  _context.heuristicSolutions.clear();
   for (int i = 0; i < t_allItems.size(); ++i)
-    Heuristic::solutions.push_back(coordinate(0, 0));
+    _context.heuristicSolutions.push_back(coordinate(0, 0));
   // create bins
   std::vector<Skyline*> headSkylines;
   for (int i = 0; i < t_Bins.size(); ++i) {
@@ -253,13 +251,13 @@ const bool StripPacking::Heuristic::generalBestFitHeurisitic(
     // if none can fit, scenario = 2
     switch (scenario) {
       case 0: {
-        addItemOverSkyline(lowestNiche, bestFitItem);
+        addItemOverSkyline(lowestNiche, bestFitItem, _context);
         break;
       }
       case 1: {
-        addItemOverSkyline(lowestNiche,
-                           bestFitItem);  // niche placement policy: place the
-                                          // item at the leftside of the niche
+        addItemOverSkyline(lowestNiche, bestFitItem,
+                           _context);  // niche placement policy: place the
+                                       // item at the leftside of the niche
         break;
       }
       case 2: {
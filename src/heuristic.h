@@ -6,15 +6,13 @@
  */
 #pragma once
 #include "skyline.h"
+#include "solvercontext.h"
 #include "spp.h"
 
 namespace StripPacking {
 class Heuristic {
- public:  // static member functions and variables
-  static std::vector<coordinate>
-      solutions;  // the order is the same as the input order
-
  public:
+  Heuristic(SolverContext& t_context) : _context(t_context) {}
   const int leftBottomHeuristic(
       const std::vector<const StripPacking::item*>& t_allItems,
       const int t_binWidth);
@@ -35,6 +33,10 @@ class Heuristic {
       std::vector<const StripPacking::item*>& t_allItems,
       const StripPacking::Skyline* t_skyline, const StripPacking::item* t_bin);
   const int parseSol(const Skyline* t_skyline);
+
+ private:
+  SolverContext& _context;  // the placements are written to
+                            // _context.heuristicSolutions
 };
 
 inline void insertItem(std::vector<const StripPacking::item*>& v,
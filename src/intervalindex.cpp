@@ -0,0 +1,68 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#include "intervalindex.h"
+
+#include <iterator>
+
+StripPacking::IntervalIndex::IntervalIndex(
+    const std::vector<item*>& t_items, const std::vector<coordinate>& t_Cords)
+    : _ranges(t_Cords.size(), std::make_pair(0, 0)),
+      _items(t_Cords.size(), nullptr) {
+  for (const auto& it : t_items) {
+    const int start = t_Cords[it->idxHelper].x;
+    _ranges[it->idxHelper] = std::make_pair(start, start + it->width);
+    _items[it->idxHelper] = it;
+    _starts.insert(std::make_pair(start, it->idxHelper));
+    _ends.insert(std::make_pair(start + it->width, it->idxHelper));
+  }
+}
+
+void StripPacking::IntervalIndex::getLefts(const item* t_item,
+                                           std::list<item*>& t_lefts) const {
+  const int start = _ranges[t_item->idxHelper].first;
+  for (auto it = _ends.begin(); it != _ends.end() && it->first <= start; ++it)
+    t_lefts.push_back(_items[it->second]);
+}
+
+void StripPacking::IntervalIndex::getRights(const item* t_item,
+                                            std::list<item*>& t_rights) const {
+  const int end = _ranges[t_item->idxHelper].second;
+  for (auto it = _starts.lower_bound(std::make_pair(end, -1));
+       it != _starts.end(); ++it)
+    t_rights.push_back(_items[it->second]);
+}
+
+const bool StripPacking::IntervalIndex::hasSeparatedItems() const {
+  return !_ends.empty() && _ends.begin()->first <= _starts.rbegin()->first;
+}
+
+const int StripPacking::IntervalIndex::getMaxEnd(const int t_column,
+                                                 const int t_none) const {
+  auto it = _ends.upper_bound(std::make_pair(t_column, int(_items.size())));
+  return it == _ends.begin() ? t_none : std::prev(it)->first;
+}
+
+const int StripPacking::IntervalIndex::getMinStart(const int t_column,
+                                                   const int t_none) const {
+  auto it = _starts.lower_bound(std::make_pair(t_column, -1));
+  return it == _starts.end() ? t_none : it->first;
+}
+
+void StripPacking::IntervalIndex::update(
+    const item* t_item, const std::vector<coordinate>& t_Cords) {
+  this->erase(t_item);
+  const int start = t_Cords[t_item->idxHelper].x;
+  _ranges[t_item->idxHelper] = std::make_pair(start, start + t_item->width);
+  _starts.insert(std::make_pair(start, t_item->idxHelper));
+  _ends.insert(std::make_pair(start + t_item->width, t_item->idxHelper));
+}
+
+void StripPacking::IntervalIndex::erase(const item* t_item) {
+  const auto& range = _ranges[t_item->idxHelper];
+  _starts.erase(std::make_pair(range.first, t_item->idxHelper));
+  _ends.erase(std::make_pair(range.second, t_item->idxHelper));
+}
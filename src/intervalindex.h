@@ -0,0 +1,49 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#pragma once
+#include <list>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "spp.h"
+namespace StripPacking {
+
+/*
+The column ranges [x, x + width) of the items of a y-check leaf, sorted by
+their first and by their last column, for the preprocessing. The items are
+found by their idxHelper in the coordinates; an item entirely at the left of
+j ends at or before x_j, so the items at the left (right) of j are a prefix
+(suffix) of one order. The ranges are updated in place when an item grows or
+is merged into another.
+*/
+class IntervalIndex {
+ public:
+  IntervalIndex(const std::vector<item*>& t_items,
+                const std::vector<coordinate>& t_Cords);
+  // the items entirely at the left (right) of t_item, by their last (first)
+  // column
+  void getLefts(const item* t_item, std::list<item*>& t_lefts) const;
+  void getRights(const item* t_item, std::list<item*>& t_rights) const;
+  // whether an item is entirely at the left of another one
+  const bool hasSeparatedItems() const;
+  // the largest end at or before t_column, t_none if there is none
+  const int getMaxEnd(const int t_column, const int t_none) const;
+  // the smallest start at or after t_column, t_none if there is none
+  const int getMinStart(const int t_column, const int t_none) const;
+  // t_item has a new x or width in t_Cords
+  void update(const item* t_item, const std::vector<coordinate>& t_Cords);
+  void erase(const item* t_item);
+
+ private:
+  typedef std::set<std::pair<int, int>> bounds;  // (column, idxHelper)
+  bounds _starts;
+  bounds _ends;
+  std::vector<std::pair<int, int>> _ranges;  // [start, end) by idxHelper
+  std::vector<item*> _items;                 // by idxHelper
+};
+}  // namespace StripPacking
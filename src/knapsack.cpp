@@ -12,42 +12,39 @@
 double dynamicPrg4KnapSack(const std::vector<double>& t_values,
                            const std::vector<int>& t_weights, int capacity,
                            std::vector<int>& t_selected) {
-  size_t itemSize = t_values.size() + 1;
-  size_t weightSize = capacity + 1;
-  double** valueMatrix = new double*[weightSize];
-  for (size_t i = 0; i < weightSize; ++i) {
-    valueMatrix[i] = new double[itemSize];
-    for (size_t j = 0; j < itemSize; ++j) {
-      valueMatrix[i][j] = 0;
-    }
-  }
-  for (size_t j = 1; j < itemSize; ++j) {
-    for (size_t i = 1; i < weightSize; ++i) {
-      if (t_weights[j - 1] > i) {
-        valueMatrix[i][j] = valueMatrix[i][j - 1];
-      } else {
-        valueMatrix[i][j] = std::max(
-            (valueMatrix[(i - t_weights[j - 1])][j - 1] + t_values[j - 1]),
-            double(valueMatrix[i][j - 1]));
-      }
+  KnapsackPricer pricer;
+  return pricer.solve(t_values, t_weights, capacity, t_selected);
+}
+
+double KnapsackPricer::solve(const std::vector<double>& t_values,
+                             const std::vector<int>& t_weights,
+                             const int t_capacity,
+                             std::vector<int>& t_selected) {
+  const size_t numItems = t_values.size();
+  const size_t rowWords = size_t(t_capacity) / 64 + 1;
+  _row.assign(t_capacity + 1, 0.0);
+  _taken.assign(numItems * rowWords, 0);
+  for (size_t j = 0; j < numItems; ++j) {
+    std::uint64_t* taken = _taken.data() + j * rowWords;
+    // downwards, so _row[i - weight] still is the value without item j
+    for (int i = t_capacity; i >= 1 && i >= t_weights[j]; --i) {
+      const double take = _row[i - t_weights[j]] + t_values[j];
+      // the reconstruction of the matrix version keeps j out unless it
+      // changes the value by at least the tolerance
+      if (take - _row[i] >= tolerance)
+        taken[i / 64] |= std::uint64_t(1) << (i % 64);
+      _row[i] = std::max(take, _row[i]);
     }
   }
-  double result = valueMatrix[weightSize - 1][itemSize - 1];
+  double result = _row[t_capacity];
   double tmpRes = result;
   // provide the solution
-  int W = capacity;
-  for (size_t j = itemSize - 1; j-- > 0 && tmpRes > 0;) {
-    if (std::abs(valueMatrix[W][j] - tmpRes) < tolerance)
-      continue;
-    else {
-      t_selected.push_back(j);
-      tmpRes -= t_values[j];
-      W -= t_weights[j];
-    }
-  }
-  for (size_t i = 0; i < weightSize; ++i) {
-    delete[] valueMatrix[i];
+  int W = t_capacity;
+  for (size_t j = numItems; j-- > 0 && tmpRes > 0;) {
+    if (!((_taken[j * rowWords + W / 64] >> (W % 64)) & 1)) continue;
+    t_selected.push_back(j);
+    tmpRes -= t_values[j];
+    W -= t_weights[j];
   }
-  delete[] valueMatrix;
   return result;
 }
@@ -5,6 +5,9 @@
  * If you have improvements, please contact me!
  */
 #pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 constexpr double tolerance = 0.0001;
@@ -80,3 +83,22 @@ std::vector<int> dynamicPrg4KnapSack(const std::vector<const T*>& items,
 double dynamicPrg4KnapSack(const std::vector<double>& t_values,
                            const std::vector<int>& t_weights, int capacity,
                            std::vector<int>& t_selected);
+
+/*
+The 0-1 knapsack of a pricing problem, solved again and again with new values.
+One rolling row of values and one decision bit per (item, capacity) instead of
+the full matrix of doubles, about n * capacity / 8 bytes, and the buffers are
+kept from one call to the next. Same optimum and same selected items as
+dynamicPrg4KnapSack.
+*/
+class KnapsackPricer {
+ public:
+  double solve(const std::vector<double>& t_values,
+               const std::vector<int>& t_weights, const int t_capacity,
+               std::vector<int>& t_selected);
+
+ private:
+  std::vector<double> _row;           // _row[c]: best value with capacity c
+  std::vector<std::uint64_t> _taken;  // bit (j, c): the best value of the
+                                      // items 0..j with capacity c takes j
+};
@@ -0,0 +1,33 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#include "lpsolver.h"
+
+#include "simplex.h"
+#ifdef SPP_USE_CPLEX
+#include "cplexsolver.h"
+#endif
+
+std::unique_ptr<StripPacking::LPSolver> StripPacking::makeLPSolver(
+    const lpBackend t_backend) {
+  switch (t_backend) {
+    case lpBackend::builtinLP:
+      return std::unique_ptr<LPSolver>(new SimplexSolver());
+#ifdef SPP_USE_CPLEX
+    case lpBackend::cplexLP:
+      return std::unique_ptr<LPSolver>(new CplexSolver());
+#endif
+    default:
+      return nullptr;
+  }
+}
+
+const bool StripPacking::lpBackendAvailable(const lpBackend t_backend) {
+#ifdef SPP_USE_CPLEX
+  if (t_backend == lpBackend::cplexLP) return true;
+#endif
+  return t_backend == lpBackend::builtinLP;
+}
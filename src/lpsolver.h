@@ -0,0 +1,62 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#pragma once
+#include <memory>
+#include <vector>
+namespace StripPacking {
+
+/*
+The LPs of the lower bounds are solved through this interface: the bundled
+simplex (always there) or CPLEX (built with SPP_USE_CPLEX defined and the
+CPLEX headers and libraries available)
+*/
+enum lpBackend { builtinLP, cplexLP, numberLPBackend };
+
+enum lpStatus {
+  lpOptimal,
+  lpInfeasible,
+  lpUnbounded,
+  lpStopped,  // time or iteration limit
+  lpError,    // numerical trouble or backend failure
+  numberLPStatus
+};
+
+enum rowSense { greaterEqual, lessEqual, equalTo, numberRowSense };
+
+constexpr double lpInfinity = 1e30;
+
+/*
+A minimization LP built row by row and then column by column; the variables
+are bounded by [0, upper]. Columns may be added between two solves, the next
+solve starts from the last basis, so that column generation only pays for
+the new columns.
+*/
+class LPSolver {
+ public:
+  virtual ~LPSolver() {}
+  // returns the index of the row
+  virtual int addRow(const rowSense t_sense, const double t_rhs) = 0;
+  // the coefficients of the column in the rows t_rows, returns its index
+  virtual int addColumn(const double t_cost, const double t_upper,
+                        const std::vector<int>& t_rows,
+                        const std::vector<double>& t_values,
+                        const bool t_integer) = 0;
+  // t_timeLimit in seconds, none if negative
+  virtual lpStatus solve(const double t_timeLimit) = 0;
+  // valid after lpOptimal
+  virtual double getObjValue() const = 0;
+  virtual double getDual(const int t_row) const = 0;
+  virtual double getValue(const int t_column) const = 0;
+};
+
+/*
+nullptr if the backend is not compiled in. The bundled simplex solves integer
+columns as continuous ones, which still gives a lower bound.
+*/
+std::unique_ptr<LPSolver> makeLPSolver(const lpBackend t_backend);
+const bool lpBackendAvailable(const lpBackend t_backend);
+}  // namespace StripPacking
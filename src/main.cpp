@@ -1,30 +1,118 @@
-#include <experimental/filesystem>
+#include <fstream>
 #include <iostream>
-#include <map>
 #include <string>
+#include <thread>
+#include <vector>
 
-#include "BLEU.h"
-#include "datareader.h"
-#include "heuristic.h"
-#include "spp.h"
-int main() {
-  const std::string instancesFolder = "./2sp/";
-  for (int i = 0; i < 1; ++i) {
-    for (const auto& entry :
-         std::experimental::filesystem::directory_iterator(instancesFolder)) {
-      std::string filePath = entry.path().relative_path().string();
-      std::cout << filePath;
-      std::vector<const StripPacking::item*> allItems;
-      StripPacking::Heuristic hrs;
-      int W = readData(filePath, allItems);
-      std::vector<const StripPacking::item*> copyItems(allItems.begin(),
-                                                       allItems.end());
-      int totalArea = 0;
-      StripPacking::BLEU alg(allItems, W, 20, 1000);
-      auto status = alg.evaluate();
-      std::cout << "The status is " << status << "\n";
-      for (auto it = allItems.begin(); it != allItems.end(); ++it) delete (*it);
-    }
+#include "batch.h"
+
+void printUsage() {
+  std::cout
+      << "usage: spp [options] <instance file or directory>...\n"
+         "  --height H      evaluate the trial height H (default 20)\n"
+         "  --optimize      search the smallest feasible height instead\n"
+         "  --time-limit T  seconds per instance (default 1000)\n"
+         "  --jobs FILE     per-instance jobs, one per line:\n"
+         "                  <file> <height|optimize> [timeLimit]\n"
+         "  --threads N     instances solved at the same time (default: "
+         "all cores)\n"
+         "  --bb-threads N  workers of the branch and bound of one instance "
+         "(default 1)\n"
+         "  --strategy S    node order of the branch and bound: dfs, best or "
+         "lds\n"
+         "                  (default dfs)\n"
+         "  --lp B          solver of the LP bounds: simplex (bundled) or "
+         "cplex\n"
+         "                  (default simplex)\n"
+         "  --output FILE   write the JSON records to FILE instead of stdout\n"
+         "  --in-process    solve the instances in this process: the jobs of\n"
+         "                  a thread share their LB4 columns, but the peak\n"
+         "                  memory of an instance is not measured (null)\n"
+         "Without instances, ./2sp/ is solved.\n";
+}
+
+bool parseStrategy(const std::string& t_name,
+                   StripPacking::searchStrategy& t_strategy) {
+  if (t_name == "dfs")
+    t_strategy = StripPacking::searchStrategy::depthFirst;
+  else if (t_name == "best")
+    t_strategy = StripPacking::searchStrategy::bestFirst;
+  else if (t_name == "lds")
+    t_strategy = StripPacking::searchStrategy::limitedDiscrepancy;
+  else
+    return false;
+  return true;
+}
+
+bool parseLPBackend(const std::string& t_name,
+                    StripPacking::lpBackend& t_backend) {
+  if (t_name == "simplex")
+    t_backend = StripPacking::lpBackend::builtinLP;
+  else if (t_name == "cplex")
+    t_backend = StripPacking::lpBackend::cplexLP;
+  else
+    return false;
+  return true;
+}
+
+int main(int argc, char** argv) {
+  StripPacking::batchMode mode = StripPacking::batchMode::evaluateHeight;
+  int trialHeight = 20;
+  int timeLimit = 1000;
+  int numThreads = std::max(1u, std::thread::hardware_concurrency());
+  int BBNumThreads = 1;
+  auto strategy = StripPacking::searchStrategy::depthFirst;
+  auto LPBackend = StripPacking::lpBackend::builtinLP;
+  bool isolate = true;
+  std::string jobFile;
+  std::string outputFile;
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--height" && hasValue)
+      trialHeight = std::stoi(argv[++i]);
+    else if (arg == "--optimize")
+      mode = StripPacking::batchMode::optimizeHeight;
+    else if (arg == "--time-limit" && hasValue)
+      timeLimit = std::stoi(argv[++i]);
+    else if (arg == "--jobs" && hasValue)
+      jobFile = argv[++i];
+    else if (arg == "--threads" && hasValue)
+      numThreads = std::stoi(argv[++i]);
+    else if (arg == "--bb-threads" && hasValue)
+      BBNumThreads = std::stoi(argv[++i]);
+    else if (arg == "--strategy" && hasValue &&
+             parseStrategy(argv[i + 1], strategy))
+      ++i;
+    else if (arg == "--lp" && hasValue &&
+             parseLPBackend(argv[i + 1], LPBackend))
+      ++i;
+    else if (arg == "--output" && hasValue)
+      outputFile = argv[++i];
+    else if (arg == "--in-process")
+      isolate = false;
+    else if (arg == "--help" || arg[0] == '-') {
+      printUsage();
+      return arg == "--help" ? 0 : 1;
+    } else
+      paths.push_back(arg);
+  }
+  if (!StripPacking::lpBackendAvailable(LPBackend)) {
+    std::cout << "this build has no CPLEX, define SPP_USE_CPLEX to use it\n";
+    return 1;
+  }
+  std::vector<StripPacking::BatchJob> jobs;
+  if (!jobFile.empty()) jobs = StripPacking::readJobFile(jobFile, timeLimit);
+  if (jobFile.empty() && paths.empty()) paths.push_back("./2sp/");
+  for (const auto& it : paths) {
+    auto tmp = StripPacking::listJobs(it, mode, trialHeight, timeLimit);
+    jobs.insert(jobs.end(), tmp.begin(), tmp.end());
   }
-  system("pause");
+  std::ofstream ofs;
+  if (!outputFile.empty()) ofs.open(outputFile);
+  std::ostream& out = outputFile.empty() ? std::cout : ofs;
+  StripPacking::runBatch(jobs, numThreads, BBNumThreads, strategy, LPBackend,
+                         isolate, out);
+  return 0;
 }
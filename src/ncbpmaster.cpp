@@ -0,0 +1,71 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#include "ncbpmaster.h"
+
+#include <algorithm>
+#include <map>
+
+const bool StripPacking::NCBPMaster::prepare(
+    const std::vector<const item*>& t_items, const int t_capacity,
+    const lpBackend t_backend) {
+  pattern rowItems;
+  for (const auto& it : t_items)
+    rowItems.push_back(std::make_pair(it->width, it->height));
+  if (_lp && t_backend == _backend && t_capacity == _capacity &&
+      rowItems == _rowItems) {
+    _reuses++;
+    return true;
+  }
+  _lp = makeLPSolver(t_backend);
+  if (!_lp) return false;
+  _builds++;
+  _backend = t_backend;
+  _capacity = t_capacity;
+  _rowItems = std::move(rowItems);
+  for (const auto& it : _rowItems)
+    _lp->addRow(rowSense::greaterEqual, it.second);
+  for (size_t i = 0; i < _rowItems.size(); ++i)
+    _lp->addColumn(1, lpInfinity, std::vector<int>(1, int(i)),
+                   std::vector<double>(1, 1.0), false);
+  // the rows of each size
+  std::map<std::pair<int, int>, std::vector<int>> rowsOfSize;
+  for (size_t i = 0; i < _rowItems.size(); ++i)
+    rowsOfSize[_rowItems[i]].push_back(int(i));
+  std::vector<int> rows;
+  for (const auto& col : _patterns) {
+    if (col.size() < 2) continue;  // a singleton is already there
+    rows.clear();
+    int width = 0;
+    size_t repeat = 0;  // the sizes are sorted, a repeated one takes the
+                        // next row of this size
+    for (size_t k = 0; k < col.size(); ++k) {
+      repeat = k > 0 && col[k] == col[k - 1] ? repeat + 1 : 0;
+      const auto it = rowsOfSize.find(col[k]);
+      if (it == rowsOfSize.end() || repeat >= it->second.size()) break;
+      rows.push_back(it->second[repeat]);
+      width += col[k].first;
+    }
+    if (rows.size() != col.size() || width > _capacity) continue;
+    _lp->addColumn(1, lpInfinity, rows, std::vector<double>(rows.size(), 1.0),
+                   false);
+    _pooledColumns++;
+  }
+  return true;
+}
+
+void StripPacking::NCBPMaster::addColumn(const std::vector<int>& t_itemIdx) {
+  std::vector<int> rows(t_itemIdx);
+  std::sort(rows.begin(), rows.end());
+  rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+  _lp->addColumn(1, lpInfinity, rows, std::vector<double>(rows.size(), 1.0),
+                 false);
+  if (_patterns.size() >= _maxPatterns) return;
+  pattern col;
+  for (const auto& it : rows) col.push_back(_rowItems[it]);
+  std::sort(col.begin(), col.end());
+  _patterns.insert(std::move(col));
+}
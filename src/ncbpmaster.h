@@ -0,0 +1,61 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#pragma once
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "lpsolver.h"
+#include "spp.h"
+namespace StripPacking {
+
+/*
+The master LP of the NCBP (LowerBound4) and the pool of the columns it has
+generated, kept from one call to the next. A column is stored by the (width,
+height) of its items, so that it can be mapped back onto any instance holding
+items of the same sizes. When the items and the capacity are those of the last
+call, the master is kept with its basis and only has to be priced again;
+otherwise it is built anew from the singleton columns plus every pooled column
+that still fits. Not thread-safe: one per thread.
+*/
+class NCBPMaster {
+ public:
+  explicit NCBPMaster(const size_t t_maxPatterns = 20000)
+      : _maxPatterns(t_maxPatterns),
+        _backend(numberLPBackend),
+        _capacity(-1),
+        _builds(0),
+        _reuses(0),
+        _pooledColumns(0) {}
+  /*
+  The master of t_items (one covering row per item, in this order) and bin
+  width t_capacity; false if the backend is not available
+  */
+  const bool prepare(const std::vector<const item*>& t_items,
+                     const int t_capacity, const lpBackend t_backend);
+  LPSolver& lp() { return *_lp; }
+  // a column made of the items t_items[idx] of prepare, kept in the pool
+  void addColumn(const std::vector<int>& t_itemIdx);
+  const long long getBuilds() const { return _builds; }
+  const long long getReuses() const { return _reuses; }
+  // columns of the pool put in the masters built so far
+  const long long getPooledColumns() const { return _pooledColumns; }
+
+ private:
+  typedef std::vector<std::pair<int, int>> pattern;  // sorted (width, height)
+  size_t _maxPatterns;  // the pool stops growing at this size
+  std::set<pattern> _patterns;
+  std::unique_ptr<LPSolver> _lp;
+  lpBackend _backend;
+  pattern _rowItems;  // (width, height) of the item of each row
+  int _capacity;
+  long long _builds;
+  long long _reuses;
+  long long _pooledColumns;
+};
+}  // namespace StripPacking
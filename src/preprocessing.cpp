@@ -5,6 +5,7 @@
  * If you have improvements, please contact me!
  */
 #include "BLEU.h"
+#include "intervalindex.h"
 
 /*
 processing for the y-check algorithm
@@ -36,31 +37,30 @@ StripPacking::BLEU::preprocessedFirst4yCheck(
     allItems.push_back(newItem);
     newItem->subItems.clear();
   }
-  std::set<int> coveredItems;
-  auto maps = this->getLeftsAndRights(allItems, t_Cords, coveredItems);
-  while (true) {
-    auto& leftItems = maps[0];
-    auto& rightItems = maps[1];
-    bool exit = true;
-    for (const auto& it : leftItems) exit &= (it.second.empty());
-    for (const auto& it : rightItems) exit &= (it.second.empty());
-    if (exit) break;
+  IntervalIndex index(allItems, t_Cords);
+  bool merged = true;
+  while (merged && index.hasSeparatedItems()) {
+    merged = false;
     std::sort(allItems.begin(), allItems.end(), compareItemByxCords(t_Cords));
     for (size_t i = 0; i < allItems.size(); ++i) {
       item* tmpItem = allItems[i];
-      if (coveredItems.find(tmpItem->idx) != coveredItems.end()) continue;
-      auto& lefts = leftItems.find(tmpItem->idx)->second;
-      auto& rights = rightItems.find(tmpItem->idx)->second;
+      std::list<item*> lefts, rights;
+      index.getLefts(tmpItem, lefts);
+      index.getRights(tmpItem, rights);
+      // the items merged into tmpItem are among these
+      std::vector<item*> neighbours(lefts.begin(), lefts.end());
+      neighbours.insert(neighbours.end(), rights.begin(), rights.end());
       // merge left
-      bool leftMergeable =
-          mergeItems4yCheck(allItems, tmpItem, leftItems, rightItems, lefts,
-                            t_Cords, true, t_Width);
+      bool leftMergeable = mergeItems4yCheck(allItems, tmpItem, lefts, t_Cords,
+                                             true, t_Width);
       // merge right
-      bool rightMergeable =
-          mergeItems4yCheck(allItems, tmpItem, leftItems, rightItems, rights,
-                            t_Cords, false, t_Width);
+      bool rightMergeable = mergeItems4yCheck(allItems, tmpItem, rights,
+                                              t_Cords, false, t_Width);
       if (leftMergeable || rightMergeable) {
-        maps = this->getLeftsAndRights(allItems, t_Cords, coveredItems);
+        for (const auto& it : neighbours)
+          if (t_Cords[it->idxHelper].x == -1) index.erase(it);
+        index.update(tmpItem, t_Cords);
+        merged = true;
         break;
       }
     }
@@ -77,95 +77,54 @@ Args:
 void StripPacking::BLEU::preprocessedSecond4yCheck(
     std::vector<item*>& t_allItems, std::vector<coordinate>& t_Cords,
     const int t_binWidth) const {
-  auto maps = this->getLeftsAndRights(t_allItems, t_Cords, std::set<int>());
+  // the items at the left of an item keep ending before it as the items grow,
+  // and those at the right keep starting after it
+  IntervalIndex index(t_allItems, t_Cords);
   std::sort(t_allItems.begin(), t_allItems.end(), compareItemByWidthLess);
   for (const auto& it : t_allItems) {
-    auto leftItems = maps[0].find(it->idx)->second;
-    auto rightItems = maps[1].find(it->idx)->second;
-    auto l_j = 0;
-    for (const auto& jt : leftItems) {
-      if (l_j < t_Cords[jt->idxHelper].x + jt->width) {
-        l_j = t_Cords[jt->idxHelper].x + jt->width;
-      }
-    }
-    auto r_j = t_binWidth;
-    for (const auto& jt : rightItems) {
-      if (r_j > t_Cords[jt->idxHelper].x) {
-        r_j = t_Cords[jt->idxHelper].x;
-      }
-    }
+    const int l_j = index.getMaxEnd(t_Cords[it->idxHelper].x, 0);
+    const int r_j =
+        index.getMinStart(t_Cords[it->idxHelper].x + it->width, t_binWidth);
     t_Cords[it->idxHelper].x = l_j;
     it->width = r_j - l_j;
+    index.update(it, t_Cords);
   }
 }
 
 /*
-Lift Item width
+Merge the runs of columns occupied by the same items
 Args:
         t_allItems: all the items after the second processed technique
         t_Cords: the coordinates of each items in t_allItems
         t_binWidth : the width of the bin
+The items on a column differ from those on the previous one only where an item
+starts or ends, so each run lies between two consecutive such columns and
+becomes a single column.
 */
 void StripPacking::BLEU::preprocessedThird4yCheck(
     std::vector<item*>& t_allItems, std::vector<coordinate>& t_Cords,
     int& t_binWidth) const {
-  std::map<int, item*> idxHelper_Items;
+  std::vector<int> bounds{0, t_binWidth};
   for (const auto& it : t_allItems) {
-    if (t_Cords[it->idxHelper].x != -1)  // dead item
-    {
-      idxHelper_Items.insert(std::pair<int, item*>(it->idxHelper, it));
-    }
+    if (t_Cords[it->idxHelper].x == -1) continue;  // dead item
+    bounds.push_back(t_Cords[it->idxHelper].x);
+    bounds.push_back(t_Cords[it->idxHelper].x + it->width);
   }
-  int cur = 0;
-  int probe = 1;
-  auto mergeCol = [](const int t_sCol, const int t_eCol,
-                     std::vector<item*>& t_ItemsInCol,
-                     std::vector<item*>& t_ItemsAfterEndCol,
-                     std::vector<coordinate>& t_Cords, int& t_binWidth) {
-    // all items in ItemsInColshould be reduced by t_eCol - t_sCol in width
-    // x coordinate of the items in ItemsAfterEndCol should should be reduced by
-    // t_eCol - t_sCol t_binWidth -= t_eCol - t_sCol
-    auto diff = t_eCol - t_sCol;
-    for (auto& it : t_ItemsInCol) it->width -= diff;
-    for (const auto& it : t_ItemsAfterEndCol) t_Cords[it->idxHelper].x -= diff;
-    t_binWidth -= diff;
-    return;
+  std::sort(bounds.begin(), bounds.end());
+  bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+  // the merged column that starts at t_column
+  auto mergedColumn = [&bounds](const int t_column) {
+    return int(std::lower_bound(bounds.begin(), bounds.end(), t_column) -
+               bounds.begin());
   };
-  while (cur < t_binWidth) {
-    const auto&& occItemsCur = this->getItemsByCol(cur, t_allItems, t_Cords);
-    // locate the right-most columns with the same items as current column
-    while (probe < t_binWidth) {
-      // yes, go on probe
-      // no, merge columns between [cur, probe-1]
-      const auto&& occItemsProb =
-          this->getItemsByCol(probe, t_allItems, t_Cords);
-      // if current column can be merged with the column being probed, continue,
-      // go on probing
-      if (occItemsCur == occItemsProb) {
-        probe++;
-      } else
-        break;
-    }
-    // found the right-most column
-    if (probe - cur > 1) {
-      // merge [cur, probe - 1]
-      std::vector<item*> ItemsInCol;
-      for (const auto& it : occItemsCur)
-        ItemsInCol.push_back(idxHelper_Items.find(it)->second);
-      std::vector<item*> ItemsAfterEndCol;
-      for (const auto& it : t_allItems) {
-        if (t_Cords[it->idxHelper].x >= probe) ItemsAfterEndCol.push_back(it);
-      }
-      mergeCol(cur, probe - 1, ItemsInCol, ItemsAfterEndCol, t_Cords,
-               t_binWidth);
-      cur++;
-      probe = cur + 1;
-      continue;
-    }
-    // update cur and probe
-    cur = probe;
-    probe++;
+  for (const auto& it : t_allItems) {
+    auto& x = t_Cords[it->idxHelper].x;
+    if (x == -1) continue;
+    const int start = mergedColumn(x);
+    it->width = mergedColumn(x + it->width) - start;
+    x = start;
   }
+  t_binWidth = int(bounds.size()) - 1;
   // assign the new coordinates
   std::vector<coordinate> newCords(t_allItems.size(), coordinate(0, 0));
   int idxHelper = 0;
@@ -189,9 +148,7 @@ the left that satisfy: p_i >= t_startColumn + w, p_i + w_i <= p_j then go to the
 first step
 */
 bool StripPacking::BLEU::mergeItems4yCheck(
-    std::vector<item*>& t_allItems, item* t_i,
-    std::map<int, std::list<item*>>& t_leftItems,
-    std::map<int, std::list<item*>>& t_rightItems, std::list<item*>& t_Items,
+    std::vector<item*>& t_allItems, item* t_i, std::list<item*>& t_Items,
     std::vector<coordinate>& t_Cords, const bool t_left,
     const int t_binWidth) const {
   if (t_Items.empty()) return false;
@@ -472,43 +429,6 @@ void StripPacking::BLEU::mergeItems(item* t_i, std::list<item*>& t_Items,
                                     std::map<int, std::list<item*>>& t_allItems,
                                     std::vector<coordinate>& t_Cords) const {}
 
-/*
-if an item is in t_coveredItems, then it has no left items and right items
-*/
-const std::vector<std::map<int, std::list<StripPacking::item*>>>
-StripPacking::BLEU::getLeftsAndRights(
-    const std::vector<item*>& t_allItems,
-    const std::vector<coordinate>& t_Cords,
-    const std::set<int>& t_coveredItems) const {
-  std::vector<std::map<int, std::list<item*>>> res;
-  std::map<int, std::list<item*>> leftItems;
-  std::map<int, std::list<item*>> rightItems;
-  for (const auto& j_it : t_allItems) {
-    leftItems.insert(
-        std::pair<int, std::list<item*>>(j_it->idx, std::list<item*>()));
-    rightItems.insert(
-        std::pair<int, std::list<item*>>(j_it->idx, std::list<item*>()));
-    if (t_coveredItems.find(j_it->idx) != t_coveredItems.end()) continue;
-    for (const auto& i_it : t_allItems) {
-      // left items
-      if (j_it->idx == i_it->idx) continue;
-
-      auto p_js = t_Cords[j_it->idxHelper].x;
-      auto p_is = t_Cords[i_it->idxHelper].x;
-      if (p_is + i_it->width <= p_js) {
-        leftItems.find(j_it->idx)->second.push_back(i_it);
-      }
-      // right items
-      if (p_js + j_it->width <= p_is) {
-        rightItems.find(j_it->idx)->second.push_back(i_it);
-      }
-    }
-  }
-  res.push_back(leftItems);
-  res.push_back(rightItems);
-  return res;
-}
-
 void StripPacking::BLEU::releaseTmpItems(
     std::vector<const item*>& t_Items) const {
   for (const auto& it : t_Items) {
@@ -0,0 +1,353 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#include "BLEU.h"
+
+namespace {
+/*
+The hash of a state is the XOR of a code per column height and per packed item,
+plus the left-most column and its maxiItemIdxColumns entry when it is looked up.
+Nothing else decides the subtree below the y-check: items only go on the
+left-most column, so the other entries of maxiItemIdxColumns are never read
+again, and the last packed item only matters for the node itself and its
+pack-nothing children, which pass criterion 1 together. The positions of the
+packed items are not part of it, so only the subtrees that failed without
+reaching a leaf (no y-check involved) are stored.
+*/
+enum stateComponent { columnHeight, packedItem, leftMostColumn };
+}  // namespace
+
+/*
+Same tree, same order and same node accounting as the stack-based DFS over
+copied nodes: the children of a node are the remaining items in increasing idx
+followed by the branch that packs nothing. Only the current node exists; the
+path from the root is kept as frames whose moves are applied to it and undone
+with the trail.
+*/
+const StripPacking::solutionStatus StripPacking::BLEU::depthFirstSearch(
+    const std::vector<const item*>& t_Items, const int t_binWidth,
+    const int t_binHeight, const int t_maxExpNodes,
+    const int t_maxDiscrepancies, int& t_numberExploredNodes,
+    bool& t_truncated) {
+  t_truncated = false;
+  BBNode state(t_Items, t_binWidth, t_binHeight);
+  // the moves are positions in remainingItems, which is kept sorted by idx
+  std::sort(state.remainingItems.begin(), state.remainingItems.end(),
+            compareItemByIdx);
+  state.packedItems.reserve(t_Items.size());
+  std::vector<BBTrailFrame> path;
+  std::vector<int> moves;
+  std::vector<int> savedHeights;
+  DynamicCutCache cutCache;
+  const int tableEntries = std::min<long long>(
+      _context.BBTranspositionEntries, 2LL * t_maxExpNodes);
+  TranspositionTable visited(std::max(tableEntries, 0));
+  std::uint64_t stateHash = 0;
+  for (int i = 0; i < t_binWidth; ++i)
+    stateHash ^= TranspositionTable::code(columnHeight, i, 0);
+  int& numberExploredNodes = t_numberExploredNodes;
+  size_t maxStackSize = 0;
+  bool newNode = true;  // the state is a node that has not been processed
+  while (true) {
+    if (newNode) {
+      newNode = false;
+      // if it's a feasible solution then invoke the y-check algorithm
+      if (state.remainingItems.empty()) {
+        if (this->yCheckAlgorithm(t_binWidth, t_binHeight, state.itemPositions,
+                                  t_Items)) {
+          SolverStatistics::updateMax(_context.statistics.BBMaxStackSize,
+                                      maxStackSize);
+          return solutionStatus::feasible;
+        }
+        if (!path.empty()) path.back().reachedLeaf = true;
+      } else {
+        const std::uint64_t key =
+            stateHash ^
+            TranspositionTable::code(
+                leftMostColumn, state.leftMostIdx,
+                state.maxiItemIdxColumns[state.leftMostIdx]);
+        if (tableEntries > 0 && visited.contains(key)) {
+          _context.statistics.fathom(BBTransposition);
+        } else if (!this->bounding(state, cutCache)) {
+          numberExploredNodes++;
+          _context.exploredNodes++;
+          if (this->checkpoint(numberExploredNodes,
+                               int(state.packedItems.size())))
+            break;
+          int discrepancies = 0;
+          if (!path.empty()) {
+            const auto& parent = path.back();
+            discrepancies = parent.discrepancies +
+                            (parent.nextMove - 1 > parent.movesBegin ? 1 : 0);
+          }
+          path.push_back(BBTrailFrame());
+          maxStackSize = std::max(maxStackSize, path.size());
+          path.back().key = key;
+          path.back().reachedLeaf = false;
+          path.back().truncated = false;
+          path.back().discrepancies = discrepancies;
+          this->listBranches(state, path.back(), moves);
+        }
+      }
+    }
+    if (path.empty()) break;
+    auto& frame = path.back();
+    if (frame.applied) {
+      this->undoBranch(state, frame.entry, savedHeights, stateHash);
+      frame.applied = false;
+    }
+    // every branch after the first one is a discrepancy
+    if (t_maxDiscrepancies >= 0 && frame.nextMove > frame.movesBegin &&
+        frame.nextMove < moves.size() &&
+        frame.discrepancies >= t_maxDiscrepancies) {
+      frame.nextMove = moves.size();
+      frame.truncated = true;
+    }
+    if (frame.nextMove == moves.size()) {  // all the children are explored
+      const bool reachedLeaf = frame.reachedLeaf;
+      const bool truncated = frame.truncated;
+      // a truncated subtree may still hold a packing
+      if (tableEntries > 0 && !reachedLeaf && !truncated)
+        visited.insert(frame.key);
+      moves.resize(frame.movesBegin);
+      path.pop_back();
+      if (path.empty()) {
+        t_truncated = truncated;
+        continue;
+      }
+      if (reachedLeaf) path.back().reachedLeaf = true;
+      if (truncated) path.back().truncated = true;
+      continue;
+    }
+    if (numberExploredNodes >= t_maxExpNodes) break;
+    this->applyBranch(state, frame, moves[frame.nextMove++], savedHeights,
+                      stateHash);
+    newNode = true;
+  }
+  SolverStatistics::updateMax(_context.statistics.BBMaxStackSize,
+                              maxStackSize);
+  // a y-check stopped by the deadline may have missed a packing
+  if (numberExploredNodes >= t_maxExpNodes || _context.stopFlag) {
+    return solutionStatus::pending;
+  } else
+    return solutionStatus::infeasible;
+}
+
+const StripPacking::solutionStatus
+StripPacking::BLEU::limitedDiscrepancySearch(
+    const std::vector<const item*>& t_Items, const int t_binWidth,
+    const int t_binHeight, const int t_maxExpNodes) {
+  int numberExploredNodes = 0;
+  for (int maxDiscrepancies = 0;; ++maxDiscrepancies) {
+    bool truncated = false;
+    const auto status = this->depthFirstSearch(
+        t_Items, t_binWidth, t_binHeight, t_maxExpNodes, maxDiscrepancies,
+        numberExploredNodes, truncated);
+    if (status != solutionStatus::infeasible || !truncated) return status;
+  }
+}
+
+/*
+Open nodes are kept in a heap up to _context.BBFrontierMaxNodes. Once it is
+full, the children of the expanded node go to a stack instead and its subtree
+is explored depth first, as makeBranch orders it, before the heap is used
+again. The node accounting is the one of the DFS.
+*/
+const StripPacking::solutionStatus StripPacking::BLEU::bestFirstSearch(
+    const std::vector<const item*>& t_Items, const int t_binWidth,
+    const int t_binHeight, const int t_maxExpNodes) {
+  BBNodePool pool;
+  std::vector<BBFrontierEntry> frontier;
+  std::stack<BBNodePtr> dive;
+  std::stack<BBNodePtr> children;
+  std::vector<BBNodePtr> buffer;
+  DynamicCutCache cutCache;
+  const size_t maxFrontier = size_t(std::max(_context.BBFrontierMaxNodes, 1));
+  size_t sequence = 0;
+  size_t maxStackSize = 0;
+  frontier.push_back(BBFrontierEntry());
+  frontier.back().slack = 0;
+  frontier.back().depth = 0;
+  frontier.back().sequence = 0;
+  frontier.back().node = pool.makeNode(t_Items, t_binWidth, t_binHeight);
+  int numberExploredNodes = 0;
+  while (numberExploredNodes < t_maxExpNodes) {
+    BBNodePtr currentNode;
+    const bool diving = !dive.empty();
+    if (diving) {
+      currentNode = std::move(dive.top());
+      dive.pop();
+    } else if (!frontier.empty()) {
+      std::pop_heap(frontier.begin(), frontier.end());
+      currentNode = std::move(frontier.back().node);
+      frontier.pop_back();
+    } else
+      break;
+    if (currentNode->remainingItems.empty()) {
+      if (this->yCheckAlgorithm(t_binWidth, t_binHeight,
+                                currentNode->itemPositions, t_Items)) {
+        SolverStatistics::updateMax(_context.statistics.BBMaxStackSize,
+                                    maxStackSize);
+        return solutionStatus::feasible;
+      }
+      continue;
+    }
+    maxStackSize = std::max(maxStackSize, frontier.size() + dive.size() + 1);
+    if (this->bounding(*currentNode, cutCache)) continue;
+    numberExploredNodes++;
+    _context.exploredNodes++;
+    if (this->checkpoint(numberExploredNodes,
+                         int(currentNode->packedItems.size())))
+      break;
+    if (diving || frontier.size() >= maxFrontier) {
+      this->makeBranch(currentNode, dive, pool);
+      continue;
+    }
+    this->makeBranch(currentNode, children, pool);
+    buffer.clear();
+    while (!children.empty()) {
+      buffer.push_back(std::move(children.top()));
+      children.pop();
+    }
+    // the first child gets the latest sequence
+    for (auto it = buffer.rbegin(); it != buffer.rend(); ++it) {
+      BBFrontierEntry entry;
+      entry.slack = this->slackArea(**it);
+      entry.depth = (*it)->packedItems.size();
+      entry.sequence = ++sequence;
+      entry.node = std::move(*it);
+      frontier.push_back(std::move(entry));
+      std::push_heap(frontier.begin(), frontier.end());
+    }
+  }
+  SolverStatistics::updateMax(_context.statistics.BBMaxStackSize,
+                              maxStackSize);
+  // a y-check stopped by the deadline may have missed a packing
+  if (numberExploredNodes >= t_maxExpNodes || _context.stopFlag) {
+    return solutionStatus::pending;
+  } else
+    return solutionStatus::infeasible;
+}
+
+const long long StripPacking::BLEU::slackArea(const BBNode& t_node) const {
+  long long slack = 0;
+  for (const auto& it : t_node.columnsOccupiedHeight)
+    slack += t_node.trialHeight - it;
+  for (const auto& it : t_node.remainingItems)
+    slack -= (long long)it->width * it->height;
+  return slack;
+}
+
+/*
+The branches of makeBranch on the left-most column, in the order they are
+explored
+*/
+void StripPacking::BLEU::listBranches(const BBNode& t_state,
+                                      BBTrailFrame& t_frame,
+                                      std::vector<int>& t_moves) const {
+  const int selectedColumn = t_state.leftMostIdx;
+  const int occupiedHeight = t_state.columnsOccupiedHeight[selectedColumn];
+  const auto& remainingItems = t_state.remainingItems;
+  t_frame.movesBegin = t_moves.size();
+  t_frame.nextMove = t_moves.size();
+  t_frame.applied = false;
+  t_frame.minHeight = 99999;
+  t_frame.secondMinHeight = 99999;
+  t_frame.minPosition = -1;
+  for (int i = 0; i < int(remainingItems.size()); ++i) {
+    const int height = remainingItems[i]->height;
+    if (height < t_frame.minHeight) {
+      t_frame.secondMinHeight = t_frame.minHeight;
+      t_frame.minHeight = height;
+      t_frame.minPosition = i;
+    } else if (height < t_frame.secondMinHeight)
+      t_frame.secondMinHeight = height;
+  }
+  // pack j on the column
+  for (int i = 0; i < int(remainingItems.size()); ++i) {
+    auto chosenItem = remainingItems[i];
+    if (chosenItem->width + selectedColumn >
+        int(t_state.columnsOccupiedHeight.size()))
+      continue;
+    if (chosenItem->height + occupiedHeight > t_state.trialHeight) continue;
+    if (t_state.maxiItemIdxColumns[selectedColumn] > chosenItem->idx) continue;
+    t_moves.push_back(i);
+  }
+  // pack nothing
+  if (occupiedHeight > 0) t_moves.push_back(-1);
+}
+
+void StripPacking::BLEU::applyBranch(BBNode& t_state, BBTrailFrame& t_frame,
+                                     const int t_move,
+                                     std::vector<int>& t_savedHeights,
+                                     std::uint64_t& t_stateHash) const {
+  const int selectedColumn = t_state.leftMostIdx;
+  auto& entry = t_frame.entry;
+  entry.position = t_move;
+  entry.column = selectedColumn;
+  entry.leftMostIdx = t_state.leftMostIdx;
+  entry.heightsBegin = t_savedHeights.size();
+  entry.stateHash = t_stateHash;
+  t_frame.applied = true;
+  if (t_move < 0) {
+    entry.placedItem = nullptr;
+    t_savedHeights.push_back(t_state.columnsOccupiedHeight[selectedColumn]);
+    t_stateHash ^= TranspositionTable::code(
+                       columnHeight, selectedColumn,
+                       t_state.columnsOccupiedHeight[selectedColumn]) ^
+                   TranspositionTable::code(columnHeight, selectedColumn,
+                                            t_state.trialHeight);
+    t_state.columnsOccupiedHeight[selectedColumn] = t_state.trialHeight;
+    t_state.leftMostIdx++;
+    return;
+  }
+  const item* chosenItem = t_state.remainingItems[t_move];
+  // the smallest height among the other remaining items
+  const int minHeight = t_move == t_frame.minPosition ? t_frame.secondMinHeight
+                                                      : t_frame.minHeight;
+  entry.placedItem = chosenItem;
+  entry.maxiItemIdx = t_state.maxiItemIdxColumns[selectedColumn];
+  entry.itemPosition = t_state.itemPositions[chosenItem->idxHelper];
+  t_state.itemPositions[chosenItem->idxHelper] = coordinate(
+      selectedColumn, t_state.columnsOccupiedHeight[selectedColumn]);
+  t_state.maxiItemIdxColumns[selectedColumn] = chosenItem->idx;
+  t_stateHash ^= TranspositionTable::code(packedItem, chosenItem->idx, 0);
+  // if there exists an item can be added on the column
+  for (int offset = 0; offset <= chosenItem->width - 1; ++offset) {
+    int& height = t_state.columnsOccupiedHeight[selectedColumn + offset];
+    t_savedHeights.push_back(height);
+    t_stateHash ^=
+        TranspositionTable::code(columnHeight, selectedColumn + offset, height);
+    if (chosenItem->height + height + minHeight <= t_state.trialHeight) {
+      height += chosenItem->height;
+    } else {
+      height = t_state.trialHeight;
+      t_state.leftMostIdx = selectedColumn + offset + 1;
+    }
+    t_stateHash ^=
+        TranspositionTable::code(columnHeight, selectedColumn + offset, height);
+  }
+  t_state.remainingItems.erase(t_state.remainingItems.begin() + t_move);
+  t_state.packedItems.push_back(chosenItem);
+}
+
+void StripPacking::BLEU::undoBranch(BBNode& t_state,
+                                    const BBTrailEntry& t_entry,
+                                    std::vector<int>& t_savedHeights,
+                                    std::uint64_t& t_stateHash) const {
+  t_stateHash = t_entry.stateHash;
+  for (size_t i = t_entry.heightsBegin; i < t_savedHeights.size(); ++i)
+    t_state.columnsOccupiedHeight[t_entry.column + i - t_entry.heightsBegin] =
+        t_savedHeights[i];
+  t_savedHeights.resize(t_entry.heightsBegin);
+  t_state.leftMostIdx = t_entry.leftMostIdx;
+  if (t_entry.placedItem == nullptr) return;
+  t_state.maxiItemIdxColumns[t_entry.column] = t_entry.maxiItemIdx;
+  t_state.itemPositions[t_entry.placedItem->idxHelper] = t_entry.itemPosition;
+  t_state.remainingItems.insert(
+      t_state.remainingItems.begin() + t_entry.position, t_entry.placedItem);
+  t_state.packedItems.pop_back();
+}
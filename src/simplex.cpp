@@ -0,0 +1,326 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#include "simplex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const double feasibilityTolerance = 1e-9;
+const double optimalityTolerance = 1e-9;
+const double pivotTolerance = 1e-9;
+// consecutive degenerate pivots before Bland's rule is used
+const int degenerateLimit = 50;
+}  // namespace
+
+StripPacking::SimplexSolver::SimplexSolver()
+    : _started(false), _pivotsSinceRefactor(0), _objValue(0.0) {}
+
+int StripPacking::SimplexSolver::addRow(const rowSense t_sense,
+                                        const double t_rhs) {
+  // the basis has no room for new rows, start again from the slacks
+  _started = false;
+  _senses.push_back(t_sense);
+  _rhs.push_back(t_rhs);
+  return int(_rhs.size()) - 1;
+}
+
+int StripPacking::SimplexSolver::addColumn(const double t_cost,
+                                           const double t_upper,
+                                           const std::vector<int>& t_rows,
+                                           const std::vector<double>& t_values,
+                                           const bool t_integer) {
+  Variable var;
+  var.kind = structural;
+  var.cost = t_cost;
+  var.upper = t_upper;
+  var.rows = t_rows;
+  var.values = t_values;
+  _variables.push_back(std::move(var));
+  _columnVariables.push_back(int(_variables.size()) - 1);
+  if (_started) {  // a new nonbasic variable at 0 keeps the basis feasible
+    _status.push_back(atLower);
+    _values.push_back(0.0);
+  }
+  return int(_columnVariables.size()) - 1;
+}
+
+/*
+The slack of a row starts basic if its value b or -b is not negative,
+otherwise an artificial variable with coefficient sign(b) does
+*/
+void StripPacking::SimplexSolver::start() {
+  const int numRows = int(_rhs.size());
+  // drop the slacks and artificials of a previous start
+  std::vector<Variable> structurals;
+  for (auto& it : _variables)
+    if (it.kind == structural) structurals.push_back(std::move(it));
+  _variables = std::move(structurals);
+  for (int i = 0; i < int(_variables.size()); ++i) _columnVariables[i] = i;
+  _status.assign(_variables.size(), atLower);
+  _values.assign(_variables.size(), 0.0);
+  _basis.assign(numRows, -1);
+  _inverse.assign(size_t(numRows) * numRows, 0.0);
+  for (int i = 0; i < numRows; ++i) {
+    double coefficient = 0.0;
+    if (_senses[i] == rowSense::greaterEqual) coefficient = -1.0;
+    if (_senses[i] == rowSense::lessEqual) coefficient = 1.0;
+    if (coefficient != 0.0) {
+      Variable var;
+      var.kind = slack;
+      var.cost = 0.0;
+      var.upper = lpInfinity;
+      var.rows.push_back(i);
+      var.values.push_back(coefficient);
+      _variables.push_back(std::move(var));
+      _status.push_back(atLower);
+      _values.push_back(0.0);
+      if (_rhs[i] * coefficient >= 0) {
+        _basis[i] = int(_variables.size()) - 1;
+        _status.back() = basic;
+        _values.back() = _rhs[i] * coefficient;
+        _inverse[size_t(i) * numRows + i] = coefficient;
+        continue;
+      }
+    }
+    coefficient = _rhs[i] >= 0 ? 1.0 : -1.0;
+    Variable var;
+    var.kind = artificial;
+    var.cost = 0.0;
+    var.upper = lpInfinity;
+    var.rows.push_back(i);
+    var.values.push_back(coefficient);
+    _variables.push_back(std::move(var));
+    _status.push_back(basic);
+    _values.push_back(std::fabs(_rhs[i]));
+    _basis[i] = int(_variables.size()) - 1;
+    _inverse[size_t(i) * numRows + i] = coefficient;
+  }
+  _duals.assign(numRows, 0.0);
+  _alpha.assign(numRows, 0.0);
+  _pivotsSinceRefactor = 0;
+  _started = true;
+}
+
+/*
+Gauss-Jordan with partial pivoting on the basis columns, then the basic
+values from the nonbasic ones
+*/
+const bool StripPacking::SimplexSolver::refactor() {
+  const int numRows = int(_rhs.size());
+  const size_t n = size_t(numRows);
+  _matrix.assign(n * n, 0.0);
+  for (int j = 0; j < numRows; ++j) {
+    const auto& var = _variables[_basis[j]];
+    for (size_t k = 0; k < var.rows.size(); ++k)
+      _matrix[size_t(var.rows[k]) * n + j] = var.values[k];
+  }
+  _inverse.assign(n * n, 0.0);
+  for (size_t i = 0; i < n; ++i) _inverse[i * n + i] = 1.0;
+  for (size_t col = 0; col < n; ++col) {
+    size_t pivot = col;
+    for (size_t i = col + 1; i < n; ++i)
+      if (std::fabs(_matrix[i * n + col]) > std::fabs(_matrix[pivot * n + col]))
+        pivot = i;
+    if (std::fabs(_matrix[pivot * n + col]) < pivotTolerance) return false;
+    if (pivot != col) {
+      std::swap_ranges(_matrix.begin() + pivot * n,
+                       _matrix.begin() + (pivot + 1) * n,
+                       _matrix.begin() + col * n);
+      std::swap_ranges(_inverse.begin() + pivot * n,
+                       _inverse.begin() + (pivot + 1) * n,
+                       _inverse.begin() + col * n);
+    }
+    const double scale = 1.0 / _matrix[col * n + col];
+    for (size_t k = 0; k < n; ++k) {
+      _matrix[col * n + k] *= scale;
+      _inverse[col * n + k] *= scale;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      const double factor = _matrix[i * n + col];
+      if (i == col || factor == 0.0) continue;
+      for (size_t k = 0; k < n; ++k) {
+        _matrix[i * n + k] -= factor * _matrix[col * n + k];
+        _inverse[i * n + k] -= factor * _inverse[col * n + k];
+      }
+    }
+  }
+  // row i of the inverse gives the value of the i-th basic variable
+  std::vector<double> rhs = _rhs;
+  for (size_t v = 0; v < _variables.size(); ++v) {
+    if (_status[v] != atUpper) continue;
+    const auto& var = _variables[v];
+    for (size_t k = 0; k < var.rows.size(); ++k)
+      rhs[var.rows[k]] -= var.values[k] * var.upper;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    double value = 0.0;
+    for (size_t k = 0; k < n; ++k) value += _inverse[i * n + k] * rhs[k];
+    _values[_basis[i]] = value;
+  }
+  _pivotsSinceRefactor = 0;
+  return true;
+}
+
+const double StripPacking::SimplexSolver::phaseCost(
+    const int t_var, const bool t_phaseOne) const {
+  const auto kind = _variables[t_var].kind;
+  if (t_phaseOne) return kind == artificial ? 1.0 : 0.0;
+  return kind == structural ? _variables[t_var].cost : 0.0;
+}
+
+StripPacking::lpStatus StripPacking::SimplexSolver::iterate(
+    const bool t_phaseOne,
+    const std::chrono::steady_clock::time_point& t_deadline,
+    const bool t_hasDeadline) {
+  const size_t n = _rhs.size();
+  const long long maxIterations =
+      10000 + 100LL * (long long)(n + _variables.size());
+  int degeneratePivots = 0;
+  for (long long iteration = 0;; ++iteration) {
+    if (iteration >= maxIterations) return lpStopped;
+    if (t_hasDeadline && iteration % 100 == 99 &&
+        std::chrono::steady_clock::now() >= t_deadline)
+      return lpStopped;
+    if (_pivotsSinceRefactor >= refactorInterval && !this->refactor())
+      return lpError;
+    // duals: the costs of the basic variables times the inverse
+    std::fill(_duals.begin(), _duals.end(), 0.0);
+    for (size_t i = 0; i < n; ++i) {
+      const double cost = this->phaseCost(_basis[i], t_phaseOne);
+      if (cost == 0.0) continue;
+      const double* row = _inverse.data() + i * n;
+      for (size_t k = 0; k < n; ++k) _duals[k] += cost * row[k];
+    }
+    // pricing
+    const bool bland = degeneratePivots >= degenerateLimit;
+    int entering = -1;
+    double best = 0.0;
+    for (int v = 0; v < int(_variables.size()); ++v) {
+      if (_status[v] == basic) continue;
+      const auto& var = _variables[v];
+      if (_status[v] == atLower && var.upper <= 0) continue;  // fixed
+      double reducedCost = this->phaseCost(v, t_phaseOne);
+      for (size_t k = 0; k < var.rows.size(); ++k)
+        reducedCost -= _duals[var.rows[k]] * var.values[k];
+      const double gain =
+          _status[v] == atLower ? -reducedCost : reducedCost;
+      if (gain <= optimalityTolerance) continue;
+      if (gain > best) {
+        best = gain;
+        entering = v;
+        if (bland) break;  // the first improving variable
+      }
+    }
+    if (entering < 0) return lpOptimal;
+    // the basic variables move by -direction * theta * alpha
+    const auto& var = _variables[entering];
+    const double direction = _status[entering] == atLower ? 1.0 : -1.0;
+    std::fill(_alpha.begin(), _alpha.end(), 0.0);
+    for (size_t k = 0; k < var.rows.size(); ++k) {
+      const double value = var.values[k];
+      const size_t col = size_t(var.rows[k]);
+      for (size_t i = 0; i < n; ++i) _alpha[i] += _inverse[i * n + col] * value;
+    }
+    // ratio test
+    double theta = var.upper;  // a bound flip of the entering variable
+    int leaving = -1;
+    bool leavingToUpper = false;
+    for (size_t i = 0; i < n; ++i) {
+      const double a = direction * _alpha[i];
+      const int basicVar = _basis[i];
+      double ratio;
+      bool toUpper;
+      if (a > pivotTolerance) {
+        ratio = std::max(_values[basicVar], 0.0) / a;
+        toUpper = false;
+      } else if (a < -pivotTolerance &&
+                 _variables[basicVar].upper < lpInfinity) {
+        ratio = std::max(_variables[basicVar].upper - _values[basicVar], 0.0) /
+                -a;
+        toUpper = true;
+      } else
+        continue;
+      bool better = ratio < theta - 1e-12;
+      if (!better && ratio <= theta + 1e-12 && leaving >= 0)
+        better = bland ? basicVar < _basis[leaving]
+                       : std::fabs(a) > std::fabs(_alpha[leaving]);
+      if (better) {
+        theta = ratio;
+        leaving = int(i);
+        leavingToUpper = toUpper;
+      }
+    }
+    if (leaving < 0 && theta >= lpInfinity) return lpUnbounded;
+    degeneratePivots = theta <= feasibilityTolerance ? degeneratePivots + 1 : 0;
+    for (size_t i = 0; i < n; ++i)
+      _values[_basis[i]] -= direction * theta * _alpha[i];
+    _values[entering] += direction * theta;
+    if (leaving < 0) {
+      _status[entering] = _status[entering] == atLower ? atUpper : atLower;
+      _values[entering] = _status[entering] == atLower ? 0.0 : var.upper;
+      continue;
+    }
+    const int leavingVar = _basis[leaving];
+    _status[leavingVar] = leavingToUpper ? atUpper : atLower;
+    _values[leavingVar] = leavingToUpper ? _variables[leavingVar].upper : 0.0;
+    _basis[leaving] = entering;
+    _status[entering] = basic;
+    // pivot on alpha[leaving]
+    double* pivotRow = _inverse.data() + size_t(leaving) * n;
+    const double scale = 1.0 / _alpha[leaving];
+    for (size_t k = 0; k < n; ++k) pivotRow[k] *= scale;
+    for (size_t i = 0; i < n; ++i) {
+      if (i == size_t(leaving) || _alpha[i] == 0.0) continue;
+      const double factor = _alpha[i];
+      double* row = _inverse.data() + i * n;
+      for (size_t k = 0; k < n; ++k) row[k] -= factor * pivotRow[k];
+    }
+    _pivotsSinceRefactor++;
+  }
+}
+
+StripPacking::lpStatus StripPacking::SimplexSolver::solve(
+    const double t_timeLimit) {
+  const bool hasDeadline = t_timeLimit >= 0;
+  const auto deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(hasDeadline ? t_timeLimit : 0.0));
+  if (!_started)
+    this->start();
+  else if (_pivotsSinceRefactor > 0 && !this->refactor())
+    return lpError;
+  double infeasibility = 0.0;
+  for (size_t v = 0; v < _variables.size(); ++v)
+    if (_variables[v].kind == artificial) infeasibility += _values[v];
+  if (infeasibility > feasibilityTolerance) {
+    for (auto& it : _variables)
+      if (it.kind == artificial) it.upper = lpInfinity;
+    const auto status = this->iterate(true, deadline, hasDeadline);
+    if (status != lpOptimal) return status;
+    infeasibility = 0.0;
+    for (size_t v = 0; v < _variables.size(); ++v)
+      if (_variables[v].kind == artificial) infeasibility += _values[v];
+    if (infeasibility > 1e-7) return lpInfeasible;
+  }
+  // the artificial variables stay at 0 from now on
+  for (size_t v = 0; v < _variables.size(); ++v) {
+    if (_variables[v].kind != artificial) continue;
+    _variables[v].upper = 0.0;
+    if (_status[v] != basic) {
+      _status[v] = atLower;
+      _values[v] = 0.0;
+    }
+  }
+  const auto status = this->iterate(false, deadline, hasDeadline);
+  if (status != lpOptimal) return status;
+  _objValue = 0.0;
+  for (const auto v : _columnVariables)
+    _objValue += _variables[v].cost * _values[v];
+  return lpOptimal;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#pragma once
+#include <chrono>
+#include <vector>
+
+#include "lpsolver.h"
+namespace StripPacking {
+
+/*
+Bounded primal revised simplex with a dense basis inverse, for the LPs of the
+lower bounds (a few hundred rows). Every row gets a slack (none for
+equalities); the rows whose slack cannot start the basis get an artificial
+variable, removed by a first phase. The inverse is updated by pivoting and
+computed again every refactorInterval pivots. Dantzig pricing, with Bland's
+rule while the pivots are degenerate, against cycling. Rows must all be added
+before the first solve; columns can be added at any time.
+*/
+class SimplexSolver : public LPSolver {
+ public:
+  SimplexSolver();
+  int addRow(const rowSense t_sense, const double t_rhs) override;
+  int addColumn(const double t_cost, const double t_upper,
+                const std::vector<int>& t_rows,
+                const std::vector<double>& t_values,
+                const bool t_integer) override;
+  lpStatus solve(const double t_timeLimit) override;
+  double getObjValue() const override { return _objValue; }
+  double getDual(const int t_row) const override { return _duals[t_row]; }
+  double getValue(const int t_column) const override {
+    return _values[_columnVariables[t_column]];
+  }
+
+ private:
+  enum variableKind { structural, slack, artificial };
+  enum variableStatus { basic, atLower, atUpper };
+  class Variable {
+   public:
+    variableKind kind;
+    double cost;
+    double upper;  // the lower bound is 0
+    std::vector<int> rows;
+    std::vector<double> values;
+  };
+  void start();
+  const bool refactor();
+  const double phaseCost(const int t_var, const bool t_phaseOne) const;
+  lpStatus iterate(const bool t_phaseOne,
+                   const std::chrono::steady_clock::time_point& t_deadline,
+                   const bool t_hasDeadline);
+
+  static const int refactorInterval = 64;
+  std::vector<rowSense> _senses;
+  std::vector<double> _rhs;
+  std::vector<Variable> _variables;
+  std::vector<int> _columnVariables;  // variable of each column
+  bool _started;
+  std::vector<int> _basis;       // basic variable of each row
+  std::vector<variableStatus> _status;
+  std::vector<double> _values;   // of all the variables
+  std::vector<double> _inverse;  // the basis inverse, row-major
+  std::vector<double> _duals;
+  std::vector<double> _alpha;    // scratch: inverse times the entering column
+  std::vector<double> _matrix;   // scratch of refactor
+  int _pivotsSinceRefactor;
+  double _objValue;
+};
+}  // namespace StripPacking
@@ -6,7 +6,6 @@
  */
 #include "skyline.h"
 
-#include "heuristic.h"
 // select a skyline for an item to place according to the given mode
 StripPacking::Skyline* StripPacking::selectSkyline(
     const StripPacking::Skyline* t_head,
@@ -45,10 +44,11 @@ StripPacking::Skyline* StripPacking::selectSkyline(
 
 // add an item over the selected skyline, see the relaxationMode
 void StripPacking::addItemOverSkyline(StripPacking::Skyline* t_skyline,
-                                      const StripPacking::item* t_item) {
+                                      const StripPacking::item* t_item,
+                                      StripPacking::SolverContext& t_context) {
   // update the placement of the solution
-  Heuristic::solutions[t_item->idx].x = t_skyline->corX;
-  Heuristic::solutions[t_item->idx].y = t_skyline->corY;
+  t_context.heuristicSolutions[t_item->idx].x = t_skyline->corX;
+  t_context.heuristicSolutions[t_item->idx].y = t_skyline->corY;
   // update the skyline
   const int scenario = t_item->width < t_skyline->length
                            ? 1
@@ -6,6 +6,7 @@
  */
 #pragma once
 
+#include "solvercontext.h"
 #include "spp.h"
 namespace StripPacking {
 enum skylineSelectionMode { leftBottom, bestFit };
@@ -25,8 +26,10 @@ struct Skyline {
 // select a skyline for an item to place according to the given mode
 Skyline* selectSkyline(const Skyline* t_head,
                        const skylineSelectionMode& t_mode);
-// add an item over the selected skyline, see the relaxationMode
-void addItemOverSkyline(Skyline* t_skyline, const item* t_item);
+// add an item over the selected skyline, see the relaxationMode; the placement
+// is recorded in t_context.heuristicSolutions
+void addItemOverSkyline(Skyline* t_skyline, const item* t_item,
+                        SolverContext& t_context);
 
 void detectAndMergeSkylines(Skyline* t_skyline);
 void removeSkyline(Skyline* t_skyline);
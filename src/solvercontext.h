@@ -0,0 +1,181 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "lpsolver.h"
+#include "ncbpmaster.h"
+#include "solverstatistics.h"
+#include "spp.h"
+#include "ycheckcache.h"
+namespace StripPacking {
+
+/*
+A snapshot of a running solve handed to the progress callback
+*/
+class SearchProgress {
+ public:
+  double elapsedSeconds;
+  long long exploredNodes;  // over the whole solve
+  double nodesPerSecond;
+  int depth;        // packed items (y-check: placed items) of the current node
+  int trialHeight;  // the height being evaluated
+  int lowerBound;   // the best bounds known so far
+  int upperBound;   // -1 when unknown
+};
+
+/*
+Everything a solve reads or writes besides its input: node limits, counters,
+status flags and the placements written by the heuristics. One context per
+solve, so that independent solves can run on different threads of the same
+process. The workers of a parallel branch and bound share the context of their
+solve, hence the atomic counters.
+*/
+class SolverContext {
+ public:
+  SolverContext()
+      : BBMaxExplNodesPerPack(10000000),
+        BBMaxExplNodesNonPerPack(80000),
+        ycheckExplNode(10000000),
+        BBNumThreads(1),
+        BBTranspositionEntries(1 << 20),
+        BBStrategy(searchStrategy::depthFirst),
+        BBFrontierMaxNodes(100000),
+        LPBackend(lpBackend::builtinLP),
+        NCBP(std::make_shared<NCBPMaster>()),
+        interestingStatics(0),
+        exploredNodes(0),
+        nodeLimitFlag(false),
+        stopFlag(false),
+        algStatus(algorithmStatus::exact),
+        progressInterval(1.0),
+        _hasDeadline(false) {
+    this->setTimeLimit(0);
+  }
+  /*
+  The deadline of the solve, t_seconds from now; none if not positive. The
+  searches read the clock every checkInterval nodes and stop with the pending
+  status once it has passed. Called when a solve starts, it also clears the
+  stop of the previous solve of the context (a deadline passed or a cancel).
+  */
+  void setTimeLimit(const double t_seconds) {
+    stopFlag = false;
+    startTime = std::chrono::steady_clock::now();
+    _lastProgress = startTime;
+    _hasDeadline = t_seconds > 0;
+    _deadline = startTime + std::chrono::duration_cast<
+                                std::chrono::steady_clock::duration>(
+                                std::chrono::duration<double>(t_seconds));
+  }
+  // stop the solve as if its deadline had passed, from any thread
+  void cancel() { stopFlag = true; }
+  // true once the solve has to stop; reads the clock
+  const bool timeUp() {
+    if (stopFlag.load(std::memory_order_relaxed)) return true;
+    if (_hasDeadline && std::chrono::steady_clock::now() >= _deadline)
+      stopFlag = true;
+    return stopFlag.load(std::memory_order_relaxed);
+  }
+  // seconds left before the deadline, a negative value when there is none
+  const double remainingSeconds() const {
+    if (!_hasDeadline) return -1.0;
+    const std::chrono::duration<double> left =
+        _deadline - std::chrono::steady_clock::now();
+    return std::max(left.count(), 0.0);
+  }
+  const double elapsedSeconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         startTime)
+        .count();
+  }
+  /*
+  Call progressCallback if progressInterval seconds went by since the last
+  call; a false answer cancels the solve
+  */
+  void reportProgress(SearchProgress& t_progress) {
+    if (!progressCallback) return;
+    std::lock_guard<std::mutex> guard(_progressLock);
+    const auto now = std::chrono::steady_clock::now();
+    if (std::chrono::duration<double>(now - _lastProgress).count() <
+        progressInterval)
+      return;
+    _lastProgress = now;
+    t_progress.elapsedSeconds =
+        std::chrono::duration<double>(now - startTime).count();
+    t_progress.exploredNodes = exploredNodes;
+    t_progress.nodesPerSecond =
+        t_progress.elapsedSeconds > 0
+            ? t_progress.exploredNodes / t_progress.elapsedSeconds
+            : 0.0;
+    if (!progressCallback(t_progress)) this->cancel();
+  }
+  static const int checkInterval = 1024;  // nodes between two clock reads
+  // limits
+  int BBMaxExplNodesPerPack;  // maximal number of explored nodes for
+                              // perfect packing (for the BB algorithm)
+  int BBMaxExplNodesNonPerPack;  // maximal number of explored nodes for
+                                 // non-perfect packing (for the BB algorithm)
+  int ycheckExplNode;  // maximal number of explored nodes of one y-check
+  int BBNumThreads;    // number of workers for the branch and bound; 1 runs
+                       // the sequential DFS
+  int BBTranspositionEntries;  // states remembered by the transposition table
+                               // of the sequential DFS, 0 disables it
+  searchStrategy BBStrategy;   // node order of the sequential branch and
+                               // bound, the parallel one is always DFS
+  int BBFrontierMaxNodes;  // open nodes kept by the best-first search; when
+                           // they are reached, it dives depth first instead
+  lpBackend LPBackend;  // solver of the LPs of LowerBound4 and LowerBound5
+  std::shared_ptr<NCBPMaster> NCBP;  // master of LowerBound4 and its columns;
+                                     // share it between the solves run one
+                                     // after the other on a thread
+  // counters and flags
+  std::atomic<int> interestingStatics;  // number of nodes cut by dynamicCuts
+  std::atomic<long long>
+      exploredNodes;  // nodes branched on by the branch and bound, summed over
+                      // all the searches of this solve
+  std::atomic<bool>
+      nodeLimitFlag;  // if y-check subroutine reaches node limit, it
+                      // becomes true;
+  std::atomic<bool> stopFlag;  // the deadline passed or the solve was
+                               // cancelled, every search returns pending
+  algorithmStatus algStatus;
+  /*
+  Explanation on the nodeLimitFlag and algStatus;
+  Before running an algorithm,
+  initialize with:
+          nodeLimitFlag = false; algStatus = exact
+  in-process:
+          as soon as ycheck exceeds node limit, nodeLimitFlag is flipped to
+  True. end: if solution status is infeasible and nodeLimitFlag = true, then the
+  algorithm is no longer exact, so algStatus = approximate
+  */
+  YCheckCache yCheckCache;  // answers of the y-check over the whole solve
+  SolverStatistics statistics;  // timings and fathoming counters
+  // heuristics
+  std::vector<coordinate>
+      heuristicSolutions;  // placements found by the last heuristic run, the
+                           // order is the same as the input order
+  // time
+  std::chrono::steady_clock::time_point startTime;
+  // called from the searching thread (any worker of a parallel search), at
+  // most once per progressInterval seconds; returning false cancels the solve
+  std::function<bool(const SearchProgress&)> progressCallback;
+  double progressInterval;  // seconds
+
+ private:
+  bool _hasDeadline;
+  std::chrono::steady_clock::time_point _deadline;
+  std::chrono::steady_clock::time_point _lastProgress;
+  std::mutex _progressLock;
+};
+}  // namespace StripPacking
@@ -0,0 +1,101 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#pragma once
+#include <atomic>
+#include <chrono>
+namespace StripPacking {
+
+// the timed parts of a solve; branchAndBound includes the y-checks it runs
+enum solverPhase {
+  preprocessingPhase,
+  lowerBound1Phase,
+  lowerBound2Phase,
+  lowerBound3Phase,
+  lowerBound4Phase,
+  lowerBound5Phase,
+  branchAndBoundPhase,
+  yCheckPhase,
+  numberSolverPhase
+};
+
+// why a node was discarded without being branched on
+enum fathomCriterion {
+  BBIdenticalItems,       // criterion 1 of bounding
+  BBArea,                 // criterion 3, the continuous bound
+  BBDynamicCut,           // criterion 4
+  BBTransposition,        // the state failed before (sequential DFS)
+  yCheckColumnHeight,     // criterion 1 of yCheckBounding
+  yCheckIdenticalItems,   // criterion 3
+  yCheckSwappedItems,     // criterion 4
+  numberFathomCriterion
+};
+
+/*
+What a solve spent its time on and how the nodes were fathomed, summed over
+the whole solve (all the trial heights of optimize, all the workers of a
+parallel search)
+*/
+class SolverStatistics {
+ public:
+  SolverStatistics()
+      : yCheckCalls(0),
+        yCheckFeasible(0),
+        yCheckNodes(0),
+        BBMaxStackSize(0),
+        yCheckMaxStackSize(0) {
+    for (auto& it : phaseNanoseconds) it = 0;
+    for (auto& it : phaseCalls) it = 0;
+    for (auto& it : fathoms) it = 0;
+  }
+  void fathom(const fathomCriterion t_criterion) {
+    fathoms[t_criterion].fetch_add(1, std::memory_order_relaxed);
+  }
+  static void updateMax(std::atomic<long long>& t_max,
+                        const long long t_value) {
+    long long current = t_max.load(std::memory_order_relaxed);
+    while (current < t_value && !t_max.compare_exchange_weak(current, t_value))
+      ;
+  }
+  const double phaseSeconds(const solverPhase t_phase) const {
+    return phaseNanoseconds[t_phase] * 1e-9;
+  }
+  std::atomic<long long> phaseNanoseconds[numberSolverPhase];
+  std::atomic<long long> phaseCalls[numberSolverPhase];
+  std::atomic<long long> fathoms[numberFathomCriterion];
+  std::atomic<long long> yCheckCalls;
+  std::atomic<long long> yCheckFeasible;
+  std::atomic<long long> yCheckNodes;  // nodes branched on by the y-checks
+  std::atomic<long long> BBMaxStackSize;  // the most open nodes (DFS: nodes
+                                          // on the path) of a search
+  std::atomic<long long> yCheckMaxStackSize;
+};
+
+/*
+Adds the wall time of its scope to a phase
+*/
+class PhaseTimer {
+ public:
+  PhaseTimer(SolverStatistics& t_statistics, const solverPhase t_phase)
+      : _statistics(t_statistics),
+        _phase(t_phase),
+        _start(std::chrono::steady_clock::now()) {}
+  ~PhaseTimer() {
+    const auto elapsed = std::chrono::steady_clock::now() - _start;
+    _statistics.phaseNanoseconds[_phase].fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+        std::memory_order_relaxed);
+    _statistics.phaseCalls[_phase].fetch_add(1, std::memory_order_relaxed);
+  }
+  PhaseTimer(const PhaseTimer&) = delete;
+  PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+ private:
+  SolverStatistics& _statistics;
+  const solverPhase _phase;
+  const std::chrono::steady_clock::time_point _start;
+};
+}  // namespace StripPacking
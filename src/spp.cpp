@@ -6,19 +6,12 @@
  */
 #include "spp.h"
 
-#include <ilcplex/ilocplex.h>
-
 #include <algorithm>
 #include <list>
 #include <set>
+#include <sstream>
 
-/*
-The paper section 2.1 (1) and (2)
-t_items: all the items
-t_idx: the item excluded (idx in the t_items)
-flag = false, --> height
-flag = true, -->  width
-*/
+#include "subsetsum.h"
 
 std::ostringstream StripPacking::item::ss;
 StripPacking::item::item(const int t_idx, const int t_width, const int t_height)
@@ -32,88 +25,66 @@ StripPacking::item::item(const int t_idx, const int t_width, const int t_height,
   subItems.clear();
 }
 
-std::set<int> StripPacking::computeFX(
-    const int t_x, const int t_idx,
-    const std::vector<const StripPacking::item*>& t_items, bool flag) {
-  std::vector<std::vector<int>> res;
-  for (size_t i = 0; i < t_items.size(); ++i) {
-    std::vector<int> tmp(t_x + 1, 0);
-    res.push_back(tmp);
-  }
-  for (size_t j = 1; j <= t_x; ++j) res[0][j] = 0;
-  for (size_t i = 0; i < t_items.size(); ++i) res[i][0] = 1;
-  int itemIdx;
-  for (size_t j = 1; j <= t_x; ++j)  // W
-  {
-    for (size_t i = 1; i < t_items.size(); ++i) {
-      if (i - 1 < t_idx)
-        itemIdx = i - 1;
-      else
-        itemIdx = i;
-      if (flag) {
-        int diff = j - t_items[itemIdx]->width;
-        if ((diff) < 0)
-          res[i][j] = res[i - 1][j];
-        else
-          res[i][j] =
-              std::max(res[i - 1][j], res[i - 1][j - t_items[itemIdx]->width]);
-      } else {
-        int diff = j - t_items[itemIdx]->height;
-        if ((diff) < 0)
-          res[i][j] = res[i - 1][j];
-        else
-          res[i][j] =
-              std::max(res[i - 1][j], res[i - 1][j - t_items[itemIdx]->height]);
-      }
-    }
-  }
-  std::set<int> possiblePositions;
-  for (size_t j = 0; j <= t_x; ++j) {
-    if (res[res.size() - 1][j] == 1) possiblePositions.insert(j);
+namespace {
+/*
+The paper section 2.1 (1) and (2)
+t_items: all the items
+flag = false, --> height
+flag = true, -->  width
+*/
+template <typename T>
+std::vector<std::set<int>> computeAllFXImpl(const int t_binSize,
+                                            const std::vector<T*>& t_items,
+                                            bool flag) {
+  std::vector<std::set<int>> result(t_items.size());
+  std::vector<int> sizes;
+  int minSize = t_binSize;
+  for (const auto& it : t_items) {
+    sizes.push_back(flag ? it->width : it->height);
+    minSize = std::min(minSize, sizes.back());
   }
-  return possiblePositions;
+  if (t_binSize - minSize < 0) return result;
+  StripPacking::leaveOneOutSubsetSums(
+      sizes, t_binSize - minSize,
+      [&](const size_t t_idx, const StripPacking::SubsetSum& t_reach) {
+        const int limit = t_binSize - sizes[t_idx];
+        for (int j = 0; j <= limit; ++j)
+          if (t_reach.reachable(j))
+            result[t_idx].insert(result[t_idx].end(), j);
+      });
+  return result;
 }
+}  // namespace
 
-std::set<int> StripPacking::computeFX(
-    const int t_x, const int t_idx,
-    const std::vector<StripPacking::item*>& t_items, bool flag) {
-  std::vector<std::vector<int>> res;
-  for (size_t i = 0; i < t_items.size(); ++i) {
-    std::vector<int> tmp(t_x + 1, 0);
-    res.push_back(tmp);
-  }
-  for (size_t j = 1; j <= t_x; ++j) res[0][j] = 0;
-  for (size_t i = 0; i < t_items.size(); ++i) res[i][0] = 1;
-  int itemIdx;
-  for (size_t j = 1; j <= t_x; ++j)  // W
-  {
-    for (size_t i = 1; i < t_items.size(); ++i) {
-      if (i - 1 < t_idx)
-        itemIdx = i - 1;
-      else
-        itemIdx = i;
-      if (flag) {
-        int diff = j - t_items[itemIdx]->width;
-        if ((diff) < 0)
-          res[i][j] = res[i - 1][j];
-        else
-          res[i][j] =
-              std::max(res[i - 1][j], res[i - 1][j - t_items[itemIdx]->width]);
-      } else {
-        int diff = j - t_items[itemIdx]->height;
-        if ((diff) < 0)
-          res[i][j] = res[i - 1][j];
-        else
-          res[i][j] =
-              std::max(res[i - 1][j], res[i - 1][j - t_items[itemIdx]->height]);
-      }
-    }
-  }
-  std::set<int> possiblePositions;
-  for (size_t j = 0; j <= t_x; ++j) {
-    if (res[res.size() - 1][j] == 1) possiblePositions.insert(j);
+std::vector<std::set<int>> StripPacking::computeAllFX(
+    const int t_binSize, const std::vector<const StripPacking::item*>& t_items,
+    bool flag) {
+  return computeAllFXImpl(t_binSize, t_items, flag);
+}
+
+std::vector<std::set<int>> StripPacking::computeAllFX(
+    const int t_binSize, const std::vector<StripPacking::item*>& t_items,
+    bool flag) {
+  return computeAllFXImpl(t_binSize, t_items, flag);
+}
+
+std::vector<int> StripPacking::countAllFX(
+    const int t_binSize, const std::vector<StripPacking::item*>& t_items,
+    bool flag) {
+  std::vector<int> result(t_items.size(), 0);
+  std::vector<int> sizes;
+  int minSize = t_binSize;
+  for (const auto& it : t_items) {
+    sizes.push_back(flag ? it->width : it->height);
+    minSize = std::min(minSize, sizes.back());
   }
-  return possiblePositions;
+  if (t_binSize - minSize < 0) return result;
+  leaveOneOutSubsetSums(sizes, t_binSize - minSize,
+                        [&](const size_t t_idx, const SubsetSum& t_reach) {
+                          result[t_idx] =
+                              t_reach.countReachable(t_binSize - sizes[t_idx]);
+                        });
+  return result;
 }
 
 int StripPacking::getMaximalHeight(
@@ -126,70 +97,72 @@ int StripPacking::getMaximalHeight(
 }
 
 /*
-Build the contiguity parallel machine scheduling problem as a lower bound for
-the spp
+Rows: one per item (= 1), then one per position used by an item, in increasing
+order (<= 0). Columns: the starts of each item in increasing order, then z.
+The positions are flat arrays over [0, last position], so that the rows of a
+column are read by a sweep over its interval: O(nonzeros) in all.
 */
-double StripPacking::solve(
+void StripPacking::buildPCCModel(
     const std::vector<const StripPacking::item*>& t_allItems,
-    const std::map<int, std::set<int>>& t_mapPosWidth,
-    const std::map<int, std::set<int>>& t_mapPosHeight, const bool t_Integer) {
-  // data preparation
-  std::set<int> allPositions;
-  for (const auto& it : t_mapPosWidth)
-    for (const auto& it2 : it.second) allPositions.insert(it2);
-  IloEnv env;
-  IloModel model(env);
-  std::map<std::string, IloNumVar> allVars;
-  // first constraints set
+    const std::map<int, std::set<int>>& t_mapPosWidth, const bool t_Integer,
+    LPSolver& t_lp) {
+  std::vector<const std::set<int>*> starts;
+  int end = 0;  // one past the last position
   for (const auto& it : t_allItems) {
-    IloExpr expr(env);
-    for (const auto& it2 : t_mapPosWidth.find(it->idx)->second) {
-      auto varName = StripPacking::getVarName(it->idx, it2);
-      if (t_Integer) {
-        IloNumVar var(env, 0, 1, ILOINT, varName.c_str());
-        allVars.insert(std::pair<std::string, IloNumVar>(varName, var));
-        expr += var;
-      } else {
-        IloNumVar var(env, 0, 1, ILOFLOAT, varName.c_str());
-        allVars.insert(std::pair<std::string, IloNumVar>(varName, var));
-        expr += var;
-      }
-    }
-    model.add(expr == 1);
-    expr.end();
+    starts.push_back(&t_mapPosWidth.find(it->idx)->second);
+    if (!starts.back()->empty())
+      end = std::max(end, *starts.back()->rbegin() + 1);
   }
-  // second constraints set
-  IloNumVar z(env, 0, IloInfinity, "ObjZ");
-  for (const auto q : allPositions) {
-    IloExpr expr(env);
-    for (const auto it : t_allItems) {
-      // calculate W(j, q)
-      for (const auto& it2 : t_mapPosWidth.find(it->idx)->second) {
-        if (it2 <= q && it2 >= q - it->width + 1) {
-          auto iter = allVars.find(StripPacking::getVarName(it->idx, it2));
-          assert(iter != allVars.end());
-          expr += iter->second * it->height;
-        }
-      }
+  // first constraints set: every item is assigned once
+  for (size_t i = 0; i < t_allItems.size(); ++i)
+    t_lp.addRow(rowSense::equalTo, 1);
+  // second constraints set: the load of each position is at most z
+  std::vector<int> rowOfPosition(end, -1);
+  for (const auto& it : starts)
+    for (const auto p : *it) rowOfPosition[p] = 0;
+  std::vector<int> positionRows;
+  for (int q = 0; q < end; ++q)
+    if (rowOfPosition[q] == 0) {
+      rowOfPosition[q] = t_lp.addRow(rowSense::lessEqual, 0);
+      positionRows.push_back(rowOfPosition[q]);
+    }
+  // the first position at or after q
+  std::vector<int> nextPosition(end + 1, end);
+  for (int q = end - 1; q >= 0; --q)
+    nextPosition[q] = rowOfPosition[q] >= 0 ? q : nextPosition[q + 1];
+  std::vector<int> rows;
+  std::vector<double> values;
+  for (size_t i = 0; i < t_allItems.size(); ++i) {
+    const int width = t_allItems[i]->width;
+    for (const auto p : *starts[i]) {
+      rows.assign(1, int(i));
+      values.assign(1, 1.0);
+      // the positions q with p <= q <= p + width - 1, W(j, q)
+      const int last = std::min(p + width, end);
+      for (int q = nextPosition[p]; q < last; q = nextPosition[q + 1])
+        rows.push_back(rowOfPosition[q]);
+      values.resize(rows.size(), t_allItems[i]->height);
+      t_lp.addColumn(0, 1, rows, values, t_Integer);
     }
-    model.add(expr <= z);
-    expr.end();
   }
-  model.add(IloMinimize(env, z));
-  IloCplex cplex(env);
-  cplex.extract(model);
-  cplex.setOut(env.getNullStream());
-  cplex.setWarning(env.getNullStream());
-  // cplex.exportModel("lowerBound5.lp");
+  values.assign(positionRows.size(), -1.0);
+  // the objective z
+  t_lp.addColumn(1, lpInfinity, positionRows, values, false);
+}
 
-  cplex.setParam(IloCplex::Param::Preprocessing::RepeatPresolve, 3);
-  cplex.setParam(IloCplex::Param::Preprocessing::Reduce, 3);
-  cplex.setParam(IloCplex::Param::MIP::Strategy::Probe, 3);
-  cplex.setParam(IloCplex::Param::Preprocessing::Symmetry, 5);
-  cplex.solve();
-  double result = cplex.getObjValue();
-  env.end();
-  return result;
+/*
+Build the contiguity parallel machine scheduling problem as a lower bound for
+the spp
+*/
+double StripPacking::solve(
+    const std::vector<const StripPacking::item*>& t_allItems,
+    const std::map<int, std::set<int>>& t_mapPosWidth, const bool t_Integer,
+    const double t_timeLimit, const lpBackend t_backend) {
+  auto lp = makeLPSolver(t_backend);
+  if (!lp) return 0.0;
+  buildPCCModel(t_allItems, t_mapPosWidth, t_Integer, *lp);
+  if (lp->solve(t_timeLimit) != lpStatus::lpOptimal) return 0.0;
+  return lp->getObjValue();
 }
 
 int StripPacking::subSetSum(const std::vector<int>& t_v, const int t_limit)
@@ -200,26 +173,8 @@ of which the sum is the largest but not exceeding the limit This is achieved by
 a simple dynamic programming algorithm Returns: The best sum.
 */
 {
-  int** values = new int*[t_v.size() + 1];
-  for (int i = 0; i < t_v.size() + 1; ++i) {
-    values[i] = new int[t_limit + 1];
-    if (i == 0) {
-      for (int j = 0; j < t_limit + 1; ++j) values[i][j] = 0;
-    }
-    values[i][0] = 0;
-  }
-
-  for (int i = 1; i < t_v.size() + 1; ++i) {
-    for (int j = 1; j < t_limit + 1; ++j) {
-      if (t_v[i - 1] > j)
-        values[i][j] = values[i - 1][j];
-      else
-        values[i][j] = std::max(values[i - 1][j - t_v[i - 1]] + t_v[i - 1],
-                                values[i - 1][j]);
-    }
-  }
-  int result = values[t_v.size()][t_limit];
-  for (int i = 0; i < t_v.size(); ++i) delete values[i];
-  delete values;
-  return result;
+  if (t_limit <= 0) return 0;
+  SubsetSum reach(t_limit);
+  for (const auto it : t_v) reach.add(it);
+  return reach.maxReachable(t_limit);
 }
@@ -11,6 +11,8 @@
 #include <set>
 #include <string>
 #include <vector>
+
+#include "lpsolver.h"
 namespace StripPacking {
 
 enum solutionStatus {
@@ -21,6 +23,29 @@ enum solutionStatus {
 };
 
 enum algorithmStatus { approximate, exact, numberAlgStatus };
+
+/*
+The order in which the branch and bound visits the nodes: depth first, best
+first on the slack area, or limited discrepancy waves over the DFS order
+*/
+enum searchStrategy {
+  depthFirst,
+  bestFirst,
+  limitedDiscrepancy,
+  numberSearchStrategy
+};
+/*
+The lower bounds of BLEU::bounds, in the order they are computed: the
+combinatorial ones, then the two LPs
+*/
+enum lowerBoundKind {
+  boundLB1,
+  boundLB2,
+  boundLB3,
+  boundLB4,
+  boundLB5,
+  numberLowerBoundKind
+};
 /*
 All fast utility function and basic structure of strip packing problem
 */
@@ -102,27 +127,37 @@ struct coordinate {
 };
 
 constexpr int BigNumber = 999999;
-std::set<int> computeFX(const int t_x, const int t_idx,
-                        const std::vector<const item*>& t_items, bool flag);
-std::set<int> computeFX(const int t_x, const int t_idx,
-                        const std::vector<StripPacking::item*>& t_items,
-                        bool flag);
+/*
+For every item i, the positions at most t_binSize - size of i reachable by a
+sum of sizes of the other items (widths if flag, heights otherwise), from one
+leave-one-out pass
+*/
+std::vector<std::set<int>> computeAllFX(const int t_binSize,
+                                        const std::vector<const item*>& t_items,
+                                        bool flag);
+std::vector<std::set<int>> computeAllFX(
+    const int t_binSize, const std::vector<StripPacking::item*>& t_items,
+    bool flag);
+// only the sizes of the sets of computeAllFX
+std::vector<int> countAllFX(const int t_binSize,
+                            const std::vector<StripPacking::item*>& t_items,
+                            bool flag);
 int getMaximalHeight(const std::vector<const item*>& t_items);
 /*
-Instance of the SPP
+The contiguous scheduling LP of solve, into an empty t_lp
+*/
+void buildPCCModel(const std::vector<const item*>& t_allItems,
+                   const std::map<int, std::set<int>>& t_mapPosWidth,
+                   const bool t_Integer, LPSolver& t_lp);
+/*
+Instance of the SPP. t_timeLimit in seconds, none if negative; 0 is returned
+if the model is not solved to optimality in time. The bundled simplex solves
+the relaxation of an integer model.
 */
 double solve(const std::vector<const item*>& t_allItems,
              const std::map<int, std::set<int>>& t_mapPosWidth,
-             const std::map<int, std::set<int>>& t_mapPosHeight,
-             const bool t_Integer);
-
-inline const std::string getVarName(const int t_itemIdx, const int t_xPos);
-
-const std::string getVarName(const int t_itemIdx, const int t_xPos) {
-  std::string str =
-      "item" + std::to_string(t_itemIdx) + "assign" + std::to_string(t_xPos);
-  return str;
-}
+             const bool t_Integer, const double t_timeLimit,
+             const lpBackend t_backend);
 
 /*
 Utilities for strip packing algorithms
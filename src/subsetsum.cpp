@@ -0,0 +1,285 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#include "subsetsum.h"
+
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SPP_AVX2_KERNEL
+#include <immintrin.h>
+#define SPP_AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define SPP_AVX2_KERNEL
+#include <immintrin.h>
+#include <intrin.h>
+#define SPP_AVX2_TARGET
+#endif
+
+namespace {
+/*
+Both kernels go from the highest word down, so the words a step reads are
+never ones it already wrote and the shift can be done in place
+*/
+void shiftOrScalar(const std::uint64_t* t_src, std::uint64_t* t_dst,
+                   const size_t t_wordShift, const int t_bitShift,
+                   const size_t t_end) {
+  for (size_t i = t_end; i-- > 0;) {
+    std::uint64_t shifted = 0;
+    if (i >= t_wordShift) {
+      shifted = t_src[i - t_wordShift] << t_bitShift;
+      if (t_bitShift > 0 && i > t_wordShift)
+        shifted |= t_src[i - t_wordShift - 1] >> (64 - t_bitShift);
+    }
+    t_dst[i] = t_src[i] | shifted;
+  }
+}
+
+#ifdef SPP_AVX2_KERNEL
+SPP_AVX2_TARGET void shiftOrAvx2(const std::uint64_t* t_src,
+                                 std::uint64_t* t_dst, const size_t t_numWords,
+                                 const size_t t_wordShift,
+                                 const int t_bitShift) {
+  const __m128i left = _mm_cvtsi32_si128(t_bitShift);
+  const __m128i right = _mm_cvtsi32_si128(64 - t_bitShift);  // 64 gives 0
+  size_t end = t_numWords;
+  // a block of 4 words [end - 4, end) needs the words down to
+  // end - 5 - t_wordShift
+  while (end >= t_wordShift + 5) {
+    const size_t first = end - 4;
+    __m256i self = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(t_src + first));
+    __m256i high = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(t_src + first - t_wordShift));
+    __m256i low = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(t_src + first - t_wordShift - 1));
+    __m256i shifted = _mm256_or_si256(_mm256_sll_epi64(high, left),
+                                      _mm256_srl_epi64(low, right));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(t_dst + first),
+                        _mm256_or_si256(self, shifted));
+    end = first;
+  }
+  shiftOrScalar(t_src, t_dst, t_wordShift, t_bitShift, end);
+}
+
+bool detectAvx2() {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  const bool osSavesYmm =
+      (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;  // OSXSAVE
+  if (!osSavesYmm) return false;
+  __cpuid(info, 0);
+  if (info[0] < 7) return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+// index of the highest set bit, t_bits != 0
+inline int highestBit(const std::uint64_t t_bits) {
+#if defined(_MSC_VER) && defined(_M_X64)
+  unsigned long index;
+  _BitScanReverse64(&index, t_bits);
+  return int(index);
+#elif defined(__GNUC__)
+  return 63 - __builtin_clzll(t_bits);
+#else
+  int bit = 63;
+  while (!(t_bits >> bit & 1)) --bit;
+  return bit;
+#endif
+}
+
+inline int lowestBit(const std::uint64_t t_bits) {
+#if defined(_MSC_VER) && defined(_M_X64)
+  unsigned long index;
+  _BitScanForward64(&index, t_bits);
+  return int(index);
+#elif defined(__GNUC__)
+  return __builtin_ctzll(t_bits);
+#else
+  int bit = 0;
+  while (!(t_bits >> bit & 1)) ++bit;
+  return bit;
+#endif
+}
+
+/*
+t_levels[t_depth] holds the sums of the weights outside [t_begin, t_end)
+*/
+void leaveOneOut(
+    const std::vector<int>& t_weights, const size_t t_begin,
+    const size_t t_end, std::vector<StripPacking::SubsetSum>& t_levels,
+    const size_t t_depth,
+    const std::function<void(const size_t, const StripPacking::SubsetSum&)>&
+        t_visit) {
+  if (t_end - t_begin == 1) {
+    t_visit(t_begin, t_levels[t_depth]);
+    return;
+  }
+  const size_t mid = (t_begin + t_end) / 2;
+  auto& inner = t_levels[t_depth + 1];
+  inner = t_levels[t_depth];
+  for (size_t i = mid; i < t_end; ++i) inner.add(t_weights[i]);
+  leaveOneOut(t_weights, t_begin, mid, t_levels, t_depth + 1, t_visit);
+  inner = t_levels[t_depth];
+  for (size_t i = t_begin; i < mid; ++i) inner.add(t_weights[i]);
+  leaveOneOut(t_weights, mid, t_end, t_levels, t_depth + 1, t_visit);
+}
+
+inline int bitCount(const std::uint64_t t_bits) {
+#if defined(_MSC_VER) && defined(_M_X64)
+  return int(__popcnt64(t_bits));
+#elif defined(__GNUC__)
+  return __builtin_popcountll(t_bits);
+#else
+  int count = 0;
+  for (std::uint64_t bits = t_bits; bits != 0; bits &= bits - 1) ++count;
+  return count;
+#endif
+}
+
+const bool useAvx2 =
+#ifdef SPP_AVX2_KERNEL
+    detectAvx2();
+#else
+    false;
+#endif
+}  // namespace
+
+const size_t StripPacking::subsetSumWords(const int t_capacity) {
+  return t_capacity < 0 ? 0 : size_t(t_capacity) / 64 + 1;
+}
+
+void StripPacking::subsetSumShiftOr(const std::uint64_t* t_src,
+                                    std::uint64_t* t_dst,
+                                    const size_t t_numWords,
+                                    const int t_shift) {
+  const size_t wordShift = size_t(t_shift) / 64;
+  const int bitShift = t_shift % 64;
+#ifdef SPP_AVX2_KERNEL
+  if (useAvx2) {
+    shiftOrAvx2(t_src, t_dst, t_numWords, wordShift, bitShift);
+    return;
+  }
+#endif
+  shiftOrScalar(t_src, t_dst, wordShift, bitShift, t_numWords);
+}
+
+const int StripPacking::subsetSumMaxBit(const std::uint64_t* t_words,
+                                        const int t_limit) {
+  if (t_limit < 0) return -1;
+  size_t word = size_t(t_limit) / 64;
+  std::uint64_t bits = t_words[word];
+  const int top = t_limit % 64;
+  if (top < 63) bits &= (std::uint64_t(1) << (top + 1)) - 1;
+  while (true) {
+    if (bits != 0) return int(word * 64) + highestBit(bits);
+    if (word == 0) return -1;
+    bits = t_words[--word];
+  }
+}
+
+const bool StripPacking::subsetSumUsesAvx2() { return useAvx2; }
+
+StripPacking::SubsetSum::SubsetSum(const int t_capacity) {
+  this->reset(t_capacity);
+}
+
+void StripPacking::SubsetSum::reset(const int t_capacity) {
+  _capacity = t_capacity;
+  _words.assign(subsetSumWords(t_capacity), 0);
+  if (!_words.empty()) _words[0] = 1;
+}
+
+void StripPacking::SubsetSum::add(const int t_weight) {
+  if (t_weight < 0 || t_weight > _capacity) return;
+  subsetSumShiftOr(_words.data(), _words.data(), _words.size(), t_weight);
+}
+
+const bool StripPacking::SubsetSum::reachable(const int t_sum) const {
+  if (t_sum < 0 || t_sum > _capacity) return false;
+  return (_words[t_sum / 64] >> (t_sum % 64)) & 1;
+}
+
+const int StripPacking::SubsetSum::maxReachable(const int t_limit) const {
+  return subsetSumMaxBit(_words.data(), std::min(t_limit, _capacity));
+}
+
+const int StripPacking::SubsetSum::countReachable(const int t_limit) const {
+  return subsetSumCountBits(_words.data(), std::min(t_limit, _capacity));
+}
+
+const int StripPacking::subsetSumCountBits(const std::uint64_t* t_words,
+                                           const int t_limit) {
+  if (t_limit < 0) return 0;
+  const size_t lastWord = size_t(t_limit) / 64;
+  int count = 0;
+  for (size_t word = 0; word <= lastWord; ++word) {
+    std::uint64_t bits = t_words[word];
+    const int top = word == lastWord ? t_limit % 64 : 63;
+    if (top < 63) bits &= (std::uint64_t(1) << (top + 1)) - 1;
+    count += bitCount(bits);
+  }
+  return count;
+}
+
+void StripPacking::leaveOneOutSubsetSums(
+    const std::vector<int>& t_weights, const int t_capacity,
+    const std::function<void(const size_t, const SubsetSum&)>& t_visit) {
+  if (t_weights.empty()) return;
+  size_t depth = 1;
+  while ((size_t(1) << (depth - 1)) < t_weights.size()) ++depth;
+  std::vector<SubsetSum> levels(depth + 1, SubsetSum(t_capacity));
+  leaveOneOut(t_weights, 0, t_weights.size(), levels, 0, t_visit);
+}
+
+std::vector<int> StripPacking::liftWeights(const std::vector<int>& t_weights,
+                                           const int t_capacity) {
+  std::vector<int> result = t_weights;
+  if (t_capacity <= 0) return result;
+  const size_t numWeights = t_weights.size();
+  // suffix[i]: the sums of the (original) weights i, i + 1, ...
+  const size_t numWords = subsetSumWords(t_capacity);
+  std::vector<std::uint64_t> suffix((numWeights + 1) * numWords, 0);
+  suffix[numWeights * numWords] = 1;
+  for (size_t i = numWeights; i-- > 0;) {
+    std::copy(suffix.begin() + (i + 1) * numWords,
+              suffix.begin() + (i + 2) * numWords,
+              suffix.begin() + i * numWords);
+    if (t_weights[i] >= 0 && t_weights[i] <= t_capacity)
+      subsetSumShiftOr(suffix.data() + i * numWords,
+                       suffix.data() + i * numWords, numWords, t_weights[i]);
+  }
+  SubsetSum prefix(t_capacity);  // the sums of the raised weights before i
+  const std::vector<std::uint64_t>& prefixWords = prefix.getWords();
+  for (size_t i = 0; i < numWeights; ++i) {
+    const int limit = t_capacity - t_weights[i];
+    if (limit > 0) {
+      // the largest a + b <= limit with a from the prefix and b from the
+      // suffix, one query of the suffix per prefix sum
+      const std::uint64_t* suffixWords = suffix.data() + (i + 1) * numWords;
+      int best = 0;
+      for (size_t word = 0; word * 64 <= size_t(limit) && best < limit;
+           ++word) {
+        for (std::uint64_t bits = prefixWords[word]; bits != 0 && best < limit;
+             bits &= bits - 1) {
+          const int a = int(word * 64) + lowestBit(bits);
+          if (a > limit) break;
+          best = std::max(best, a + subsetSumMaxBit(suffixWords, limit - a));
+        }
+      }
+      if (best + t_weights[i] < t_capacity) result[i] = t_capacity - best;
+    }
+    prefix.add(result[i]);
+  }
+  return result;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+namespace StripPacking {
+
+/*
+Subset-sum reachability as a bitset: bit s is set iff some subset of the
+weights added so far sums to s. Adding a weight w is reach |= reach << w, one
+pass over capacity / 64 words (4 words per instruction with AVX2, picked at
+runtime), instead of a row of capacity + 1 ints of the knapsack DP.
+*/
+class SubsetSum {
+ public:
+  explicit SubsetSum(const int t_capacity);
+  void reset(const int t_capacity);  // back to the empty subset only
+  void add(const int t_weight);
+  const bool reachable(const int t_sum) const;
+  // the largest reachable sum not exceeding t_limit
+  const int maxReachable(const int t_limit) const;
+  // the number of reachable sums not exceeding t_limit
+  const int countReachable(const int t_limit) const;
+  const int getCapacity() const { return _capacity; }
+  const std::vector<std::uint64_t>& getWords() const { return _words; }
+
+ private:
+  int _capacity;
+  std::vector<std::uint64_t> _words;
+};
+
+/*
+Leave-one-out subset sums: t_visit(i, sums) is called for every i, in
+increasing order, with the sums up to t_capacity of all the weights but the
+i-th. Divide and conquer over the weights, O(n log n) shift-ORs in total instead
+of one DP per left-out weight.
+*/
+void leaveOneOutSubsetSums(
+    const std::vector<int>& t_weights, const int t_capacity,
+    const std::function<void(const size_t, const SubsetSum&)>& t_visit);
+/*
+Raise the weights in order: w_i becomes t_capacity - s_i when s_i, the largest
+subset sum of the other weights not above t_capacity - w_i, leaves a gap, the
+weights before i being the raised ones (the width and height lifting of the
+preprocessing). The weights after i are shared through suffix sums, so this is
+O(n * t_capacity) instead of one DP per weight.
+*/
+std::vector<int> liftWeights(const std::vector<int>& t_weights,
+                             const int t_capacity);
+
+/*
+The kernels on raw words, for callers keeping several bitsets in one buffer.
+t_numWords words of 64 sums each; t_dst may be t_src.
+*/
+const size_t subsetSumWords(const int t_capacity);
+// t_dst = t_src | (t_src << t_shift)
+void subsetSumShiftOr(const std::uint64_t* t_src, std::uint64_t* t_dst,
+                      const size_t t_numWords, const int t_shift);
+// the largest set bit not above t_limit, -1 if there is none
+const int subsetSumMaxBit(const std::uint64_t* t_words, const int t_limit);
+// the number of set bits not above t_limit
+const int subsetSumCountBits(const std::uint64_t* t_words, const int t_limit);
+// true if the AVX2 kernel is used on this machine
+const bool subsetSumUsesAvx2();
+}  // namespace StripPacking
@@ -0,0 +1,53 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#include "transpositiontable.h"
+
+namespace {
+std::uint64_t mix(std::uint64_t t_value) {  // splitmix64
+  t_value += 0x9e3779b97f4a7c15ull;
+  t_value = (t_value ^ (t_value >> 30)) * 0xbf58476d1ce4e5b9ull;
+  t_value = (t_value ^ (t_value >> 27)) * 0x94d049bb133111ebull;
+  return t_value ^ (t_value >> 31);
+}
+
+std::uint64_t nonZero(const std::uint64_t t_key) { return t_key ? t_key : 1; }
+}  // namespace
+
+StripPacking::TranspositionTable::TranspositionTable(
+    const size_t t_numEntries) {
+  size_t numBuckets = 1;
+  while (numBuckets * _bucketSize < t_numEntries) numBuckets *= 2;
+  _bucketMask = numBuckets - 1;
+  _slots.assign(numBuckets * _bucketSize, 0);
+}
+
+const bool StripPacking::TranspositionTable::contains(
+    const std::uint64_t t_key) const {
+  const std::uint64_t key = nonZero(t_key);
+  const std::uint64_t* bucket =
+      _slots.data() + (key & _bucketMask) * _bucketSize;
+  for (size_t i = 0; i < _bucketSize; ++i)
+    if (bucket[i] == key) return true;
+  return false;
+}
+
+void StripPacking::TranspositionTable::insert(const std::uint64_t t_key) {
+  const std::uint64_t key = nonZero(t_key);
+  std::uint64_t* bucket = _slots.data() + (key & _bucketMask) * _bucketSize;
+  for (size_t i = 0; i < _bucketSize; ++i)
+    if (bucket[i] == key) return;
+  // the slots of a bucket are kept from the newest to the oldest
+  for (size_t i = _bucketSize - 1; i > 0; --i) bucket[i] = bucket[i - 1];
+  bucket[0] = key;
+}
+
+const std::uint64_t StripPacking::TranspositionTable::code(
+    const int t_kind, const int t_first, const int t_second) {
+  return mix((std::uint64_t(std::uint32_t(t_kind)) << 56) ^
+             (std::uint64_t(std::uint32_t(t_first)) << 28) ^
+             std::uint64_t(std::uint32_t(t_second)));
+}
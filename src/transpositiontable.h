@@ -0,0 +1,37 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+namespace StripPacking {
+
+/*
+A fixed-size set of 64-bit state hashes, e.g. the branch and bound states whose
+subtree has been searched without success. Buckets of 4 slots; a new key
+replaces the oldest one of its bucket, so the table never grows and forgets
+the states it has no room for.
+*/
+class TranspositionTable {
+ public:
+  explicit TranspositionTable(const size_t t_numEntries);
+  const bool contains(const std::uint64_t t_key) const;
+  void insert(const std::uint64_t t_key);
+  /*
+  Zobrist-style codes of the state components, computed on the fly instead of
+  a table of random numbers: the hash of a state is the XOR of the codes of its
+  components, so it is updated in O(1) per changed component
+  */
+  static const std::uint64_t code(const int t_kind, const int t_first,
+                                  const int t_second);
+
+ private:
+  static const size_t _bucketSize = 4;
+  size_t _bucketMask;
+  std::vector<std::uint64_t> _slots;  // 0 is an empty slot
+};
+}  // namespace StripPacking
@@ -0,0 +1,64 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#include "ycheckcache.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+void StripPacking::YCheckCache::makeKey(const int t_binWidth,
+                                        const int t_binHeight,
+                                        const std::vector<const item*>& t_items,
+                                        const std::vector<coordinate>& t_Cords,
+                                        std::vector<int>& t_key) {
+  std::vector<std::array<int, 3>> placements;
+  placements.reserve(t_items.size());
+  for (const auto& it : t_items)
+    placements.push_back({t_Cords[it->idxHelper].x, it->width, it->height});
+  std::sort(placements.begin(), placements.end());
+  t_key.clear();
+  t_key.reserve(2 + 3 * placements.size());
+  t_key.push_back(t_binWidth);
+  t_key.push_back(t_binHeight);
+  for (const auto& it : placements)
+    t_key.insert(t_key.end(), it.begin(), it.end());
+}
+
+const int StripPacking::YCheckCache::find(const std::vector<int>& t_key) {
+  std::lock_guard<std::mutex> guard(_lock);
+  auto ptr = _answers.find(t_key);
+  if (ptr == _answers.end()) {
+    _misses++;
+    return -1;
+  }
+  _hits++;
+  return ptr->second ? 1 : 0;
+}
+
+void StripPacking::YCheckCache::insert(const std::vector<int>& t_key,
+                                       const bool t_feasible) {
+  std::lock_guard<std::mutex> guard(_lock);
+  if (_capacity == 0) return;
+  if (_answers.size() >= _capacity) _answers.clear();
+  _answers[t_key] = t_feasible;
+}
+
+void StripPacking::YCheckCache::setCapacity(const size_t t_capacity) {
+  std::lock_guard<std::mutex> guard(_lock);
+  _capacity = t_capacity;
+  if (_answers.size() >= _capacity) _answers.clear();
+}
+
+size_t StripPacking::YCheckCache::KeyHash::operator()(
+    const std::vector<int>& t_key) const {
+  std::uint64_t hash = 0x9e3779b97f4a7c15ull;
+  for (const auto it : t_key) {
+    hash ^= std::uint64_t(std::uint32_t(it)) + 0x9e3779b97f4a7c15ull +
+            (hash << 6) + (hash >> 2);
+  }
+  return size_t(hash);
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright Xiangyi Zhang 2021
+ * The code may be used for academic, non-commercial purposes only.
+ * Please contact me at xiangyi.zhang@polymtl.ca for questions
+ * If you have improvements, please contact me!
+ */
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "spp.h"
+namespace StripPacking {
+
+/*
+Answers of the y-check, keyed by the instance it decides: the bin width, the
+height and the sorted (x, width, height) of the items. The ids of the items play
+no role in the answer, so leaves placing items of the same sizes on the same
+columns share an entry, before and after the y-check preprocessing. Only exact
+answers are stored, not the ones cut by the node limit. The cache is emptied
+when it holds t_capacity entries; a capacity of 0 disables it. Thread-safe.
+*/
+class YCheckCache {
+ public:
+  explicit YCheckCache(const size_t t_capacity = 100000)
+      : _capacity(t_capacity), _hits(0), _misses(0) {}
+  static void makeKey(const int t_binWidth, const int t_binHeight,
+                      const std::vector<const item*>& t_items,
+                      const std::vector<coordinate>& t_Cords,
+                      std::vector<int>& t_key);
+  // 1 if feasible, 0 if infeasible, -1 if the key is unknown
+  const int find(const std::vector<int>& t_key);
+  void insert(const std::vector<int>& t_key, const bool t_feasible);
+  void setCapacity(const size_t t_capacity);
+  const long long getHits() const { return _hits; }
+  const long long getMisses() const { return _misses; }
+
+ private:
+  class KeyHash {
+   public:
+    size_t operator()(const std::vector<int>& t_key) const;
+  };
+  std::mutex _lock;
+  size_t _capacity;
+  std::unordered_map<std::vector<int>, bool, KeyHash> _answers;
+  std::atomic<long long> _hits;
+  std::atomic<long long> _misses;
+};
+}  // namespace StripPacking